@@ -0,0 +1,92 @@
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <fsm/fsm_ecpp.h>
+
+using namespace ecpp::fsm;
+
+// Events
+struct write { int value {0}; };
+struct flush {};
+
+// State machine definition
+struct bounded_buffer_def {
+    //@{
+    /** @name States */
+    struct empty   : state<empty> {};
+    struct filled  : state<filled> {
+        // the action may fail, the machine stays in the current state
+        struct on_write : fallible_action {
+            bool operator()(const write &event, auto &fsm) const {
+                return fsm.push(event.value);
+            }
+        };
+
+        using internal_transitions = transition_table<
+            /*  Event    Action     */
+            in< write,   on_write   >
+        >;
+    };
+    //@}
+
+    struct on_first_write : fallible_action {
+        bool operator()(const write &event, auto &fsm) const {
+            return fsm.push(event.value);
+        }
+    };
+
+    // the result of an ordinary action is discarded, even if it is a bool
+    struct on_flush {
+        bool operator()(const flush &, auto &fsm) const {
+            const bool t_full = fsm.m_size == fsm.m_data.size();
+            fsm.m_size = 0;
+            return t_full;
+        }
+    };
+
+    using initial_state = empty;
+    using transitions   = transition_table
+    <   /*  State     Event    Next      Action           */
+        tr< empty,    write,   filled,   on_first_write   >,
+        tr< filled,   flush,   empty,    on_flush         >
+    >;
+
+    bool push(int value) {
+        if (m_size == m_data.size())
+            return false;
+        m_data[m_size++] = value;
+        return true;
+    }
+
+    std::array<int, 2> m_data {};
+    std::size_t m_size {0};
+};
+
+// State machine object
+using bounded_buffer = ecpp::fsm::state_machine<bounded_buffer_def>;
+
+int main(int argc, char *argv[])
+{
+    bounded_buffer fsm;
+
+    assert(fsm.is_in_state<bounded_buffer_def::empty>());
+    assert(fsm.process_event(write{1}) == result::done);
+    assert(fsm.is_in_state<bounded_buffer_def::filled>());
+    assert(fsm.process_event(write{2}) == result::done);
+    assert(fsm.process_event(write{3}) == result::failed);  // buffer full
+    assert(fsm.is_in_state<bounded_buffer_def::filled>());
+    assert(fsm.process_event(flush{}) == result::done);
+    assert(fsm.is_in_state<bounded_buffer_def::empty>());
+
+    // a failed transition action returns the machine to the source state
+    fsm.m_size = fsm.m_data.size();
+    assert(fsm.process_event(write{4}) == result::failed);
+    assert(fsm.is_in_state<bounded_buffer_def::empty>());
+
+    fsm.m_size = 0;
+    assert(fsm.process_event(write{5}) == result::done);
+    assert(fsm.process_event(flush{}) == result::done);  // on_flush returned false
+    assert(fsm.is_in_state<bounded_buffer_def::empty>());
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "turnstile_def.h"
+#include "turnstile_profile.h"
+
+// Skewed workload: 99% of the events are push
+std::vector<bool> make_workload(std::size_t size)
+{
+    std::vector<bool> t_coins(size);
+    std::uint32_t t_seed {12345};
+    for (std::size_t i {0}; i < size; ++i) {
+        t_seed = t_seed * 1664525u + 1013904223u;
+        t_coins[i] = (t_seed >> 16) % 100 == 0;
+    }
+    return t_coins;
+}
+
+template <class Machine>
+double run(Machine &fsm, const std::vector<bool> &workload, std::size_t rounds)
+{
+    const auto t_begin = std::chrono::steady_clock::now();
+    for (std::size_t r {0}; r < rounds; ++r) {
+        for (const bool t_coin : workload) {
+            if (t_coin)
+                fsm.process_event(coin{});
+            else
+                fsm.process_event(push{});
+        }
+    }
+    const auto t_end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t_end - t_begin).count() / static_cast<double>(workload.size() * rounds);
+}
+
+int main(int argc, char *argv[])
+{
+    const auto workload = make_workload(1 << 20);
+
+    // 1. record (state, event) frequencies with the counting policy
+    state_machine<turnstile_def, profile_counter> counter;
+    run(counter, workload, 1);
+    if (argc > 1 && std::strcmp(argv[1], "--write-profile") == 0) {
+        counter.write_profile(std::cout, "turnstile_profile");
+        return 0;
+    }
+
+    // 2. compare the default dispatch with the profile-guided one
+    state_machine<turnstile_def> plain;
+    state_machine<turnstile_def, turnstile_profile> guided;
+
+    constexpr std::size_t rounds {50};
+    const double plain_ns  = run(plain, workload, rounds);
+    const double guided_ns = run(guided, workload, rounds);
+
+    std::cout << "default dispatch:       " << plain_ns  << " ns/event" << std::endl;
+    std::cout << "profile-guided dispatch: " << guided_ns << " ns/event" << std::endl;
+
+    // both machines must observe the same behaviour
+    return plain.m_beeps == guided.m_beeps && plain.m_coins == guided.m_coins && counter.m_beeps * rounds == plain.m_beeps ? 0 : 1;
+}
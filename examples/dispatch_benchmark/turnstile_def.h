@@ -0,0 +1,52 @@
+#pragma once
+
+#include <fsm/fsm_ecpp.h>
+
+using namespace ecpp::fsm;
+
+// Events
+struct push {};
+struct coin {};
+struct failure {};
+struct repair {};
+
+// State machine definition
+struct turnstile_def {
+    //@{
+    /** @name States */
+    struct locked : state<locked> {
+        struct beep {
+            void operator()(const push &, auto &fsm) const {
+                ++fsm.m_beeps;
+            }
+        };
+
+        using internal_transitions = transition_table<
+            /*  Event     Action  */
+            in< push,     beep    >
+        >;
+    };
+
+    struct unlocked : state<unlocked> {};
+    struct broken   : state<broken> {};
+    //@}
+
+    struct on_blink {
+        void operator()(const coin &, auto &fsm) const {
+            ++fsm.m_coins;
+        }
+    };
+
+    using initial_state = locked;
+    using transitions   = transition_table
+    <   /*  State       Event       Next        Action    */
+        tr< broken,     repair,     locked                >,
+        tr< unlocked,   failure,    broken                >,
+        tr< locked,     failure,    broken                >,
+        tr< locked,     coin,       unlocked,   on_blink  >,
+        tr< unlocked,   push,       locked                >
+    >;
+
+    unsigned m_beeps {0};
+    unsigned m_coins {0};
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+// generated by ecpp::fsm::state_machine<T, profile_counter>::write_profile()
+
+using turnstile_profile = ecpp::fsm::profile<
+    ecpp::fsm::hit<turnstile_def::unlocked, coin, 111>,
+    ecpp::fsm::hit<turnstile_def::unlocked, push, 10313>,
+    ecpp::fsm::hit<turnstile_def::locked, coin, 10313>,
+    ecpp::fsm::hit<turnstile_def::locked, push, 1027839>
+>;
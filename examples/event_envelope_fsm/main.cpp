@@ -0,0 +1,93 @@
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <fsm/fsm_ecpp.h>
+
+using namespace ecpp::fsm;
+
+// Events
+struct connect    { std::uint16_t port {0}; };
+struct disconnect {};
+struct payload    { std::array<std::uint8_t, 128> data {}; std::size_t size {0}; };
+
+// State machine definition
+struct link_def {
+    //@{
+    /** @name States */
+    struct idle      : state<idle> {};
+    struct connected : state<connected> {
+        struct on_payload {
+            void operator()(const payload &event, auto &fsm) const {
+                fsm.m_received += event.size;
+            }
+        };
+
+        using internal_transitions = transition_table<
+            /*  Event      Action      */
+            in< payload,   on_payload  >
+        >;
+    };
+    //@}
+
+    using initial_state = idle;
+    using transitions   = transition_table
+    <   /*  State       Event          Next       */
+        tr< idle,       connect,       connected  >,
+        tr< connected,  disconnect,    idle       >
+    >;
+
+    std::size_t m_received {0};
+};
+
+// State machine object
+using link = ecpp::fsm::state_machine<link_def>;
+
+// Decoder of the wire format: the first byte selects the event type
+link::event_envelope_t decode(const std::uint8_t *msg, std::size_t size, event_pool_base &pool)
+{
+    switch (msg[0]) {
+    case 0x01: return link::event_envelope_t{connect{static_cast<std::uint16_t>(msg[1] << 8 | msg[2])}};
+    case 0x02: return link::event_envelope_t{disconnect{}};
+    case 0x03: {
+        // payload does not fit the inline buffer and is placed in the pool
+        link::event_envelope_t t_envelope;
+        if (auto *t_payload = t_envelope.emplace<payload>(pool)) {
+            t_payload->size = size - 1;
+            for (std::size_t i {1}; i < size; ++i)
+                t_payload->data[i - 1] = msg[i];
+        }
+        return t_envelope;
+    }
+    default: return {};
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    event_pool<sizeof(payload), 4> pool;
+    link fsm;
+
+    const std::uint8_t msg_connect[]    {0x01, 0x1f, 0x90};
+    const std::uint8_t msg_payload[]    {0x03, 'h', 'e', 'l', 'l', 'o'};
+    const std::uint8_t msg_disconnect[] {0x02};
+    const std::uint8_t msg_unknown[]    {0xff};
+
+    assert(fsm.is_in_state<link_def::idle>());
+    assert(fsm.process_event(decode(msg_payload, sizeof(msg_payload), pool)) == result::refuse);
+    assert(fsm.process_event(decode(msg_connect, sizeof(msg_connect), pool)) == result::done);
+    assert(fsm.is_in_state<link_def::connected>());
+    assert(fsm.process_event(decode(msg_payload, sizeof(msg_payload), pool)) == result::done);
+    assert(fsm.m_received == 5);
+    assert(fsm.process_event(decode(msg_unknown, sizeof(msg_unknown), pool)) == result::refuse);
+    assert(fsm.process_event(decode(msg_disconnect, sizeof(msg_disconnect), pool)) == result::done);
+    assert(fsm.is_in_state<link_def::idle>());
+
+    // an exhausted pool is reported by emplace() and leaves the envelope empty
+    link::event_envelope_t held[5];
+    for (std::size_t i {0}; i < 4; ++i)
+        assert(held[i].emplace<payload>(pool) != nullptr);
+    assert(held[4].emplace<payload>(pool) == nullptr);
+    assert(held[4].empty());
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include <fsm/fsm_ecpp.h>
+
+using namespace ecpp::fsm;
+
+// Events
+struct route   { std::size_t link {0}; };
+struct degrade { std::size_t link {0}; };
+struct reset   {};
+
+// State machine definition
+struct router_def {
+    // counts state hooks of every machine, forks included
+    struct counted {
+        void on_entry(const auto &, auto &) { ++s_entries; }
+        void on_entry(auto &) { ++s_entries; }
+        void on_exit(const auto &, auto &) { ++s_exits; }
+        void on_exit(auto &) { ++s_exits; }
+
+        inline static int s_entries {0};
+        inline static int s_exits {0};
+    };
+
+    //@{
+    /** @name States */
+    struct ready : state<ready>, counted {
+        struct on_degrade {
+            void operator()(const degrade &event, auto &fsm) const {
+                fsm.m_links.mutate().at(event.link) = 0; // the shared table is copied here, once
+            }
+        };
+
+        using internal_transitions = transition_table<
+            /*  Event      Action      */
+            in< degrade,   on_degrade  >
+        >;
+    };
+
+    struct routed : state<routed>, counted {};
+    //@}
+
+    struct is_up {
+        bool operator()(const route &event, const auto &fsm) const {
+            return fsm.m_links->at(event.link) > 0;
+        }
+    };
+
+    using initial_state = ready;
+    using transitions   = transition_table
+    <   /*  State     Event     Next      Action   Guard   */
+        tr< ready,    route,    routed,   none,    is_up   >,
+        tr< routed,   reset,    ready                      >
+    >;
+
+    // large routing table shared by all forks until one of them changes it
+    cow<std::vector<int>> m_links {std::in_place, std::vector<int>(100000, 1)};
+};
+
+// State machine object
+using router = ecpp::fsm::state_machine<router_def>;
+
+// hooks run by a fork are balanced: it neither enters nor leaves the state inherited from its parent
+template <class... Events>
+bool balanced(router &parent, Events... events)
+{
+    const auto t_entries = router_def::counted::s_entries;
+    const auto t_exits = router_def::counted::s_exits;
+    {
+        router twig = parent.fork();
+        (static_cast<void>(twig.process_event(std::move(events))), ...);
+    }
+    return router_def::counted::s_entries - t_entries == router_def::counted::s_exits - t_exits;
+}
+
+int main(int argc, char *argv[])
+{
+    router fsm;
+
+    // evaluate "what happens if" speculatively without touching the original machine
+    for (std::size_t link {0}; link < 1000; ++link) {
+        auto branch = fsm.fork();
+        assert(fsm.m_links.use_count() == 2); // the table is shared, not copied
+
+        if (link % 2 == 0)
+            assert(branch.process_event(degrade{link}) == result::done);
+        assert(branch.process_event(route{link}) == (link % 2 == 0 ? result::refuse : result::done));
+    }
+
+    assert(fsm.m_links.use_count() == 1);
+    assert(fsm.is_in_state<router_def::ready>());
+
+    // moving a shared table shares it once more, the source stays usable
+    {
+        cow<std::vector<int>> links {fsm.m_links};
+        cow<std::vector<int>> moved {std::move(links)};
+        assert(links->size() == moved->size());
+        assert(fsm.m_links.use_count() == 3);
+    }
+    assert(fsm.m_links.use_count() == 1);
+
+    // only the original machine entered its state, 500 forks entered and left "routed" themselves
+    assert(router_def::counted::s_entries == 1 + 500);
+    assert(router_def::counted::s_exits == 500);
+
+    assert(balanced(fsm, route{1}));
+    assert(balanced(fsm, route{1}, reset{}, route{2}));
+    assert(balanced(fsm, degrade{3}, route{3}));
+
+    assert(fsm.process_event(route{0}) == result::done);
+
+    // a fork keeps the current state and has the type of its parent, a fork of a fork works the same way
+    {
+        router branch = fsm.fork();
+        assert(branch.is_in_state<router_def::routed>());
+        assert(balanced(branch, reset{}));
+
+        auto twig = branch.fork();
+        assert(twig.process_event(reset{}) == result::done);
+        assert(balanced(twig, route{1}));
+    }
+    assert(router_def::counted::s_entries == router_def::counted::s_exits + 1);
+
+    return 0;
+}
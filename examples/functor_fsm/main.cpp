@@ -0,0 +1,83 @@
+#include <cassert>
+#include <fsm/fsm_ecpp.h>
+
+using namespace ecpp::fsm;
+
+// Events
+struct start  {};
+struct tick   {};
+struct sample {};
+
+// State machine definition
+struct meter_def {
+    // action instance is created once together with the machine and keeps its counter between events
+    struct count_ticks {
+        count_ticks() { ++s_instances; }
+
+        void operator()(const tick &, auto &fsm) {
+            fsm.m_ticks = ++m_count;
+        }
+
+        int m_count {0};
+        inline static int s_instances {0};
+    };
+
+    // action constructible from the definition receives it on creation
+    struct record {
+        explicit record(meter_def &def) : m_def{def} {}
+
+        void operator()(const sample &, auto &fsm) {
+            fsm.m_bound = &m_def == &fsm;
+            ++m_def.m_samples;
+        }
+
+        meter_def &m_def;
+    };
+
+    //@{
+    /** @name States */
+    struct idle : state<idle> {};
+
+    struct running : state<running> {
+        using internal_transitions = transition_table<
+            /*  Event    Action       */
+            in< tick,    count_ticks  >,
+            in< sample,  record       >
+        >;
+    };
+    //@}
+
+    using initial_state = idle;
+    using transitions   = transition_table
+    <   /*  State   Event   Next      */
+        tr< idle,   start,  running   >
+    >;
+
+    int m_ticks {0};
+    int m_samples {0};
+    bool m_bound {false};
+};
+
+// State machine object
+using meter = ecpp::fsm::state_machine<meter_def>;
+
+int main(int argc, char *argv[])
+{
+    meter fsm;
+    assert(meter_def::count_ticks::s_instances == 1);
+
+    assert(fsm.process_event(start{}) == result::done);
+    for (int i {0}; i < 3; ++i)
+        assert(fsm.process_event(tick{}) == result::done);
+
+    // the same instance handled every event
+    assert(fsm.m_ticks == 3);
+    assert(meter_def::count_ticks::s_instances == 1);
+
+    assert(fsm.process_event(sample{}) == result::done);
+    assert(fsm.process_event(sample{}) == result::done);
+    assert(fsm.m_samples == 2);
+    assert(fsm.m_bound);
+
+    return 0;
+}
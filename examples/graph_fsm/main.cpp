@@ -0,0 +1,100 @@
+#include <cassert>
+#include <cstdio>
+#include <string_view>
+#include <fsm/fsm_graph_ecpp.h>
+
+using namespace ecpp::fsm;
+
+// Events
+struct power  {};
+struct dim    {};
+
+// State machine definition
+struct lamp_def {
+    struct has_power {
+        bool operator()(const power &, const auto &) const { return true; }
+    };
+
+    struct lower {
+        void operator()(const dim &, auto &) const {}
+    };
+
+    //@{
+    /** @name States */
+    struct off : state<off> {};
+
+    struct on : state<on> {
+        using internal_transitions = transition_table<
+            /*  Event   Action  */
+            in< dim,    lower   >
+        >;
+    };
+    //@}
+
+    using initial_state = off;
+    using transitions   = transition_table
+    <   /*  State   Event   Next   Action   Guard      */
+        tr< off,    power,  on,    none,    has_power  >,
+        tr< on,     power,  off                        >
+    >;
+};
+
+using lamp_graph = graph::table<lamp_def::transitions>;
+
+// two table rows followed by the internal row of the "on" state
+static_assert(graph_size<lamp_def>() == 3);
+static_assert(graph_size<lamp_def::transitions>() == 3);
+static_assert(lamp_graph::state_count == 2);
+
+static_assert(!lamp_graph::rows()[0].internal);
+static_assert(graph::short_name(lamp_graph::rows()[0].guard) == "has_power");
+static_assert(lamp_graph::rows()[0].action.empty());
+static_assert(lamp_graph::rows()[1].guard.empty());
+
+static_assert(lamp_graph::rows()[2].internal);
+static_assert(lamp_graph::rows()[2].source == lamp_graph::rows()[2].target);
+static_assert(graph::short_name(lamp_graph::rows()[2].source) == "on");
+static_assert(graph::short_name(lamp_graph::rows()[2].event) == "dim");
+static_assert(graph::short_name(lamp_graph::rows()[2].action) == "lower");
+
+constexpr bool contains(std::string_view text, std::string_view part)
+{
+    return text.find(part) != std::string_view::npos;
+}
+
+// the output is built by the compiler as well
+constexpr bool check_dot()
+{
+    const auto t_dot = to_dot<lamp_def>();
+    return t_dot.starts_with("digraph fsm {\n")
+        && contains(t_dot, "__initial [shape=point];")
+        && contains(t_dot, "[label=\"power [has_power]\"];")
+        && contains(t_dot, "[label=\"dim / lower\", style=dashed];")
+        && t_dot.ends_with("}\n");
+}
+
+constexpr bool check_json()
+{
+    const auto t_json = to_json<lamp_def::transitions>();
+    return t_json.starts_with("{\n  \"initial\": null,")
+        && contains(t_json, "\"action\": null, \"guard\": null, \"internal\": false}")
+        && contains(t_json, "\"internal\": true}\n  ]\n}\n");
+}
+
+static_assert(check_dot());
+static_assert(check_json());
+
+int main(int argc, char *argv[])
+{
+    const transition_stats t_stats[graph_size<lamp_def>()] {{1000, 12.5}, {500, 40.0}, {0, 0.0}};
+
+    const auto t_dot = to_dot<lamp_def>(t_stats);
+    assert(contains(t_dot, "\\nhits: 1000, ns: 12.500\", color=\"0.000 1.000 0.900\", penwidth=5.000]"));
+    assert(contains(t_dot, "\\nhits: 0, ns: 0.000\", color=\"0.667 1.000 0.900\", penwidth=1.000, style=dashed]"));
+
+    const auto t_json = to_json<lamp_def>(t_stats);
+    assert(contains(t_json, "\"hits\": 500, \"latency_ns\": 40.000}"));
+
+    std::fputs(t_dot.c_str(), stdout);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <cassert>
+#include <fsm/fsm_ecpp.h>
+
+using namespace ecpp::fsm;
+
+// Events
+struct request { int value {0}; };
+struct probe   {};
+struct release {};
+
+// State machine definition
+struct gate_def {
+    //@{
+    /** @name States */
+    struct idle : state<idle> {};
+    struct busy : state<busy> {};
+    //@}
+
+    // pure guard: evaluated at most once per event, however often it appears in the expression
+    struct valid : pure_guard {
+        bool operator()(const request &event, const auto &fsm) const {
+            ++fsm.m_valid_calls;
+            return event.value > 0;
+        }
+    };
+
+    // empty guard is created in place on every call, its names do not clash with members of the definition
+    struct has_quota {
+        static int size() { return 0; }
+
+        bool operator()(const auto &, const auto &fsm) const {
+            ++fsm.m_quota_calls;
+            return fsm.size() > size();
+        }
+    };
+
+    // guard stored in the definition, its state is kept in mutable members
+    struct lock {
+        bool operator()(const release &, const auto &) const {
+            ++m_calls;
+            return m_open;
+        }
+
+        bool m_open {false};
+        mutable int m_calls {0};
+    };
+
+    // a member guard names a member declared before the transition table
+    int size() const { return m_quota; }
+
+    int m_quota {1};
+    lock m_lock;
+    mutable int m_valid_calls {0};
+    mutable int m_quota_calls {0};
+
+    using initial_state = idle;
+    using transitions   = transition_table
+    <   /*  State   Event     Next    Action   Guard                                                  */
+        tr< idle,   request,  busy,   none,    and_<valid, or_<not_<valid>, valid>, has_quota, has_quota> >,
+        tr< idle,   probe,    busy,   none,    or_<has_quota, has_quota>                              >,
+        tr< busy,   release,  idle,   none,    member<&gate_def::m_lock>                              >
+    >;
+};
+
+// State machine object
+using gate = ecpp::fsm::state_machine<gate_def>;
+
+int main(int argc, char *argv[])
+{
+    gate fsm;
+
+    // an invalid request is refused after a single evaluation of each guard
+    assert(fsm.process_event(request{0}) == result::refuse);
+    assert(fsm.m_valid_calls == 1);
+    assert(fsm.m_quota_calls == 0);
+
+    // the pure guard is cached within the nested expression, the repeated has_quota runs once
+    assert(fsm.process_event(request{1}) == result::done);
+    assert(fsm.is_in_state<gate_def::busy>());
+    assert(fsm.m_valid_calls == 2);
+    assert(fsm.m_quota_calls == 1);
+
+    // the member guard refuses the transition while the lock is closed
+    assert(fsm.process_event(release{}) == result::refuse);
+    assert(fsm.is_in_state<gate_def::busy>());
+    assert(fsm.m_lock.m_calls == 1);
+
+    fsm.m_lock.m_open = true;
+    assert(fsm.process_event(release{}) == result::done);
+    assert(fsm.is_in_state<gate_def::idle>());
+    assert(fsm.m_lock.m_calls == 2);
+
+    // duplicates in or_<> are evaluated once as well
+    fsm.m_quota = 0;
+    assert(fsm.size() == 0);
+    assert(fsm.process_event(probe{}) == result::refuse);
+    assert(fsm.m_quota_calls == 2);
+
+    return 0;
+}
@@ -0,0 +1,234 @@
+#include <cassert>
+#include <fsm/fsm_pipeline_ecpp.h>
+
+using namespace ecpp::fsm;
+
+// Events of the framing stage
+struct character { char value {0}; };
+// Events of the session stage
+struct command { char code {0}; };
+// Events of the application stage
+struct request {};
+struct shutdown {};
+
+// Application: counts requests of authorized sessions
+struct application_def {
+    //@{
+    /** @name States */
+    struct serving : state<serving> {
+        struct on_request {
+            void operator()(const request &, auto &fsm) const {
+                ++fsm.m_requests;
+            }
+        };
+
+        using internal_transitions = transition_table<
+            /*  Event      Action       */
+            in< request,   on_request   >
+        >;
+    };
+    struct stopped : state<stopped> {};
+    //@}
+
+    using initial_state = serving;
+    using transitions   = transition_table
+    <   /*  State      Event       Next      */
+        tr< serving,   shutdown,   stopped   >
+    >;
+
+    int m_requests {0};
+};
+
+// Session: 'L' logs in, 'R' forwards a request while logged in
+struct session_def : emits<application_def, 1, request> {
+    //@{
+    /** @name States */
+    struct anonymous  : state<anonymous> {};
+    struct authorized : state<authorized> {
+        struct forward : fallible_action {
+            bool operator()(const command &, auto &fsm) const {
+                return fsm.emit(request{});
+            }
+        };
+
+        struct is_request {
+            bool operator()(const command &event, const auto &) const {
+                return event.code == 'R';
+            }
+        };
+
+        using internal_transitions = transition_table<
+            /*  Event      Action     Guard       */
+            in< command,   forward,   is_request  >
+        >;
+    };
+    //@}
+
+    struct is_login {
+        bool operator()(const command &event, const auto &) const {
+            return event.code == 'L';
+        }
+    };
+
+    using initial_state = anonymous;
+    using transitions   = transition_table
+    <   /*  State       Event      Next         Action   Guard      */
+        tr< anonymous,  command,   authorized,  none,    is_login   >
+    >;
+};
+
+// Framing: every line is a command, its first character is the command code
+struct framing_def : emits<session_def, 1, command> {
+    //@{
+    /** @name States */
+    struct line_start : state<line_start> {};
+    struct line_body  : state<line_body> {};
+    //@}
+
+    struct on_code {
+        void operator()(const character &event, auto &fsm) const {
+            fsm.m_code = event.value;
+        }
+    };
+
+    struct on_end_of_line : fallible_action {
+        bool operator()(const character &, auto &fsm) const {
+            return fsm.emit(command{fsm.m_code});
+        }
+    };
+
+    struct is_code {
+        bool operator()(const character &event, const auto &) const {
+            return event.value != '\n';
+        }
+    };
+
+    struct is_end_of_line {
+        bool operator()(const character &event, const auto &) const {
+            return event.value == '\n';
+        }
+    };
+
+    using initial_state = line_start;
+    using transitions   = transition_table
+    <   /*  State        Event        Next         Action           Guard            */
+        tr< line_start,  character,   line_body,   on_code,         is_code          >,
+        tr< line_body,   character,   line_start,  on_end_of_line,  is_end_of_line   >
+    >;
+
+    char m_code {0};
+};
+
+// Pipeline object: framing -> session -> application
+using server = ecpp::fsm::pipeline<framing_def, session_def, application_def>;
+
+// Events of the counter stage
+struct pulse {};
+struct burst {};
+struct overflow {};
+struct halt {};
+
+// Counter: counts overflows
+struct counter_def {
+    //@{
+    /** @name States */
+    struct counting : state<counting> {
+        struct on_overflow {
+            void operator()(const overflow &, auto &fsm) const {
+                ++fsm.m_overflows;
+            }
+        };
+
+        using internal_transitions = transition_table<
+            /*  Event       Action        */
+            in< overflow,   on_overflow   >
+        >;
+    };
+    struct halted : state<halted> {};
+    //@}
+
+    using initial_state = counting;
+    using transitions   = transition_table
+    <   /*  State      Event   Next     */
+        tr< counting,  halt,   halted   >
+    >;
+
+    int m_overflows {0};
+};
+
+// Divider: an outbox of several events and stored actions emitting into it
+struct divider_def : emits<counter_def, 2, overflow> {
+    //@{
+    /** @name States */
+    struct low  : state<low> {};
+    struct high : state<high> {};
+    //@}
+
+    // stored action: it keeps the number of carries
+    struct carry : fallible_action {
+        bool operator()(const pulse &, auto &fsm) {
+            ++m_carries;
+            return fsm.emit(overflow{}) && fsm.emit(overflow{});
+        }
+
+        int m_carries {0};
+    };
+
+    // the third event does not fit into the outbox, the transition fails
+    struct flood : fallible_action {
+        bool operator()(const burst &, auto &fsm) const {
+            return fsm.emit(overflow{}) && fsm.emit(overflow{}) && fsm.emit(overflow{});
+        }
+    };
+
+    using initial_state = low;
+    using transitions   = transition_table
+    <   /*  State   Event   Next   Action   */
+        tr< low,    pulse,  high            >,
+        tr< high,   pulse,  low,   carry    >,
+        tr< low,    burst,  high,  flood    >
+    >;
+};
+
+using divider = ecpp::fsm::pipeline<divider_def, counter_def>;
+
+int main(int argc, char *argv[])
+{
+    server pipeline;
+
+    for (const char c : {'R', '\n'})
+        pipeline.process_event(character{c});
+    assert(pipeline.stage<1>().is_in_state<session_def::anonymous>());
+    assert(pipeline.stage<2>().m_requests == 0);
+    assert(pipeline.undelivered() == 1); // the anonymous session refused the command
+
+    for (const char c : {'L', 'x', '\n', 'R', '\n'})
+        pipeline.process_event(character{c});
+    assert(pipeline.stage<1>().is_in_state<session_def::authorized>());
+    assert(pipeline.stage<2>().m_requests == 1);
+    assert(pipeline.stage<0>().is_in_state<framing_def::line_start>());
+    assert(pipeline.undelivered() == 1);
+
+    divider chain;
+    assert(chain.process_event(pulse{}) == result::done);
+    assert(chain.process_event(pulse{}) == result::done);
+    assert(chain.stage<0>().is_in_state<divider_def::low>());
+    assert(chain.stage<1>().m_overflows == 2);
+
+    // events emitted before the failure are dropped, not forwarded
+    assert(chain.process_event(burst{}) == result::failed);
+    assert(chain.stage<0>().is_in_state<divider_def::low>());
+    assert(chain.stage<1>().m_overflows == 2);
+
+    assert(chain.process_event(pulse{}) == result::done);
+    assert(chain.process_event(pulse{}) == result::done);
+    assert(chain.stage<1>().m_overflows == 4);
+    assert(chain.undelivered() == 0);
+
+    // outside a pipeline the outbox is cleared before every event, so emit() keeps working
+    ecpp::fsm::state_machine<divider_def> alone;
+    for (int i {0}; i < 10; ++i)
+        assert(alone.process_event(pulse{}) == result::done);
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <fsm/fsm_scanner_ecpp.h>
+
+using namespace ecpp::fsm;
+
+// Events (byte classes)
+struct digit   { std::byte value; };
+struct blank   {};
+struct hash    {};
+struct newline {};
+
+// Byte classifier
+struct number_classes : byte_classes<digit, blank, hash, newline> {
+    static constexpr std::size_t classify(std::byte b) noexcept {
+        const auto c = static_cast<char>(b);
+        if (c >= '0' && c <= '9') return 0;
+        if (c == '#')             return 2;
+        if (c == '\n')            return 3;
+        return 1;
+    }
+};
+
+// State machine definition: sums the numbers of a text, '#' starts a comment up to the end of line
+struct number_sum_def {
+    //@{
+    /** @name States */
+    struct idle : state<idle> {
+        using internal_transitions = transition_table<
+            /*  Event      Action  */
+            in< blank,     none    >,
+            in< newline,   none    >
+        >;
+    };
+
+    struct number : state<number> {
+        struct append {
+            void operator()(const digit &event, auto &fsm) const {
+                fsm.m_value = fsm.m_value * 10 + (static_cast<int>(event.value) - '0');
+            }
+        };
+
+        using internal_transitions = transition_table<
+            /*  Event      Action  */
+            in< digit,     append  >
+        >;
+    };
+
+    // the comment body is skipped without calling the machine, up to the newline
+    struct comment : state<comment> {
+        using internal_transitions = transition_table<
+            /*  Event      Action  */
+            in< digit,     none    >,
+            in< blank,     none    >,
+            in< hash,      none    >
+        >;
+    };
+    //@}
+
+    struct start {
+        void operator()(const digit &event, auto &fsm) const {
+            fsm.m_value = static_cast<int>(event.value) - '0';
+        }
+    };
+
+    struct commit {
+        void operator()(const auto &, auto &fsm) const {
+            fsm.m_sum += fsm.m_value;
+        }
+    };
+
+    using initial_state = idle;
+    using transitions   = transition_table
+    <   /*  State      Event      Next       Action   */
+        tr< idle,      digit,     number,    start    >,
+        tr< idle,      hash,      comment             >,
+        tr< number,    blank,     idle,      commit   >,
+        tr< number,    newline,   idle,      commit   >,
+        tr< number,    hash,      comment,   commit   >,
+        tr< comment,   newline,   idle                >
+    >;
+
+    int m_value {0};
+    int m_sum {0};
+};
+
+// Scanner object
+using number_sum = ecpp::fsm::scanner<number_sum_def, number_classes>;
+
+int main(int argc, char *argv[])
+{
+    number_sum scanner;
+
+    const char text[] = "12 30\n# comment 100 with a long tail of text to skip # 7\n  8\n";
+    const auto result = scanner.scan({reinterpret_cast<const std::byte*>(text), std::strlen(text)});
+
+    assert(result.status == result::done);
+    assert(result.consumed == std::strlen(text));
+    assert(scanner.machine().m_sum == 50);
+    assert(scanner.machine().is_in_state<number_sum_def::idle>());
+
+    // the scanner can be resumed on the next chunk
+    const char chunk[] = "# 1\n4";
+    assert(scanner.scan({reinterpret_cast<const std::byte*>(chunk), std::strlen(chunk)}).status == result::done);
+    assert(scanner.machine().is_in_state<number_sum_def::number>());
+
+    return 0;
+}
@@ -1,4 +1,3 @@
-#include <cassert>
 #include <fsm/fsm_ecpp.h>
 
 using namespace ecpp::fsm;
@@ -28,15 +27,27 @@ struct minimal_def {
 // State machine object
 using minimal = ecpp::fsm::state_machine<minimal_def>;
 
-int main(int argc, char *argv[])
+// The whole event sequence is evaluated by the compiler
+constexpr bool use()
 {
     minimal fsm;
 
-    assert(fsm.is_in_state<minimal_def::initial>());
-    assert(fsm.process_event(start{}) == result::done);
-    assert(fsm.is_in_state<minimal_def::running>());
-    assert(fsm.process_event(stop{})  == result::done);
-    assert(fsm.is_in_state<minimal_def::terminated>());
+    return fsm.is_in_state<minimal_def::initial>()
+        && fsm.process_event(start{}) == result::done
+        && fsm.is_in_state<minimal_def::running>()
+        && fsm.process_event(stop{})  == result::done
+        && fsm.is_in_state<minimal_def::terminated>();
+}
+
+static_assert(use());
 
-    return 0;
+// an empty definition without actions costs only the current state;
+// the MSVC ABI ignores [[no_unique_address]] of the profile counters, so the check is limited to GCC and Clang
+#if !defined(_MSC_VER)
+static_assert(sizeof(minimal) == sizeof(minimal::states_t));
+#endif
+
+int main(int argc, char *argv[])
+{
+    return use() ? 0 : 1;
 }
@@ -15,20 +15,54 @@ concept CallActionShort = requires(A action, E event, F fsm) {
     action(event, fsm);
 };
 
+// базовый класс действия, которое может завершиться неудачей: его результат проверяется,
+// результат остальных действий, как и прежде, отбрасывается
+struct fallible_action {};
+
+template <class A>
+concept IsFallibleAction = std::is_base_of_v<fallible_action, A>;
+
+// результат действия, которое может завершиться неудачей: bool либо тип, подобный std::expected
+template<class R>
+concept IsActionStatus = std::same_as<R, bool> || requires(const R &status) {
+    { status.has_value() } -> std::convertible_to<bool>;
+};
+
+template<IsActionStatus R>
+constexpr bool action_succeeded(const R &status) noexcept {
+    if constexpr (std::same_as<R, bool>)
+        return status;
+    else
+        return status.has_value();
+}
+
 template <class A>
 struct call_action {
+    template<class E, class F, class S, class D> requires CallActionLong<A&, E, F, S, D>
+    constexpr decltype(auto) operator()(A &action, const E &event, F &fsm, S &src, D &dst) noexcept {
+        return action(event, fsm, src, dst);
+    }
+
+    template<class E, class F, class S, class D> requires CallActionShort<A&, E, F>
+    constexpr decltype(auto) operator()(A &action, const E &event, F &fsm, S&, D&) noexcept {
+        return action(event, fsm);
+    }
+
+    template<class E, class F, class S, class D>
+    constexpr void operator()(A&, const E&, F&, S&, D&) noexcept {}
+
     template<class E, class F, class S, class D> requires CallActionLong<A, E, F, S, D>
-    void operator()(const E &event, F &fsm, S &src, D &dst) noexcept {
-        A{}(event, fsm, src, dst);
+    constexpr decltype(auto) operator()(const E &event, F &fsm, S &src, D &dst) noexcept {
+        return A{}(event, fsm, src, dst);
     }
 
     template<class E, class F, class S, class D> requires CallActionShort<A, E, F>
-    void operator()(const E &event, F &fsm, S&, D&) noexcept {
-        A{}(event, fsm);
+    constexpr decltype(auto) operator()(const E &event, F &fsm, S&, D&) noexcept {
+        return A{}(event, fsm);
     }
 
     template<class E, class F, class S, class D>
-    void operator()(const E&, F&, S&, D&) noexcept {}
+    constexpr void operator()(const E&, F&, S&, D&) noexcept {}
 };
 
 }
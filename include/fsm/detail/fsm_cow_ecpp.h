@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace ecpp::fsm {
+
+/**
+ * \class cow
+ * \brief Данные определения автомата, разделяемые копиями автомата (см. state_machine::fork) до первого изменения.
+ * Счётчик ссылок не атомарный, как и весь автомат, cow предназначен для однопоточного использования.
+ * Перемещение выполняется как копирование, поэтому cow никогда не бывает пустым.
+ * \tparam Data - тип разделяемых данных.
+ */
+template <class Data>
+class cow {
+    struct block {
+        std::size_t refs;
+        Data data;
+    };
+
+public:
+    constexpr cow() requires std::is_default_constructible_v<Data> : m_block{new block{1, Data{}}} {}
+
+    template <class... Args>
+    constexpr explicit cow(std::in_place_t, Args&&... args) : m_block{new block{1, Data{std::forward<Args>(args)...}}} {}
+
+    constexpr cow(const cow &other) noexcept : m_block{other.m_block} {
+        ++m_block->refs;
+    }
+
+    constexpr cow& operator=(cow other) noexcept {
+        std::swap(m_block, other.m_block);
+        return *this;
+    }
+
+    constexpr ~cow() {
+        if (--m_block->refs == 0)
+            delete m_block;
+    }
+
+    // доступ только на чтение, данные не копируются
+    [[nodiscard]] constexpr const Data &get() const noexcept { return m_block->data; }
+    [[nodiscard]] constexpr const Data &operator*() const noexcept { return m_block->data; }
+    [[nodiscard]] constexpr const Data *operator->() const noexcept { return &m_block->data; }
+
+    /**
+     * \brief Доступ на запись: если данные разделяются с другими копиями, предварительно создаётся собственная копия.
+     */
+    [[nodiscard]] constexpr Data &mutate() {
+        if (m_block->refs > 1) {
+            auto *t_block = new block{1, m_block->data};
+            --m_block->refs;
+            m_block = t_block;
+        }
+        return m_block->data;
+    }
+
+    // количество копий, разделяющих данные
+    [[nodiscard]] constexpr std::size_t use_count() const noexcept { return m_block->refs; }
+
+private:
+    block *m_block;
+};
+
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "fsm_meta_lib_ecpp.h"
+#include "fsm_event_pool_ecpp.h"
+
+namespace ecpp::fsm {
+
+/**
+ * \class event_envelope
+ * \brief Контейнер для любого события таблицы переходов с компактным тегом типа.
+ * Небольшие события хранятся во встроенном буфере, крупные - в блоке event_pool.
+ * \tparam Table - таблица переходов, события которой может содержать конверт.
+ * \tparam InlineSize - размер встроенного буфера в байтах.
+ */
+template <class Table, std::size_t InlineSize = 32>
+class event_envelope {
+    // список всех уникальных событий таблицы переходов (в том числе внутренних)
+    using events_t = typename Table::all_events_t;
+    static constexpr std::size_t count = meta::pack_size<events_t>::value;
+    // тег хранимого события, максимальное значение означает пустой конверт
+    using tag_t = std::conditional_t<(count < std::numeric_limits<std::uint8_t>::max()), std::uint8_t, std::uint16_t>;
+    static constexpr tag_t empty_tag = std::numeric_limits<tag_t>::max();
+
+    static_assert(InlineSize >= sizeof(void*), "inline buffer must be able to hold a pool block pointer");
+
+public:
+    using transitions_t = Table;
+
+    template <class E>
+    static constexpr bool has_event = meta::contains<E>(events_t{});
+
+    // событие помещается во встроенный буфер
+    template <class E>
+    static constexpr bool fits_inline = sizeof(E) <= InlineSize && alignof(E) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<E>;
+
+    event_envelope() noexcept = default;
+
+    // конструктора с пулом нет: исчерпание пула сообщает только emplace(pool, ...), возвращая nullptr
+
+    template <class E> requires has_event<std::decay_t<E>> && fits_inline<std::decay_t<E>>
+    explicit event_envelope(E &&event) noexcept {
+        emplace<std::decay_t<E>>(std::forward<E>(event));
+    }
+
+    event_envelope(const event_envelope&) = delete;
+    event_envelope& operator=(const event_envelope&) = delete;
+
+    event_envelope(event_envelope &&other) noexcept {
+        take(other);
+    }
+
+    event_envelope& operator=(event_envelope &&other) noexcept {
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    ~event_envelope() {
+        reset();
+    }
+
+    /**
+     * \brief Создание события во встроенном буфере.
+     * \return указатель на созданное событие.
+     */
+    template <class E, class... Args> requires has_event<E> && fits_inline<E>
+    E *emplace(Args&&... args) noexcept {
+        reset();
+        auto *t_event = ::new (static_cast<void*>(m_storage)) E{std::forward<Args>(args)...};
+        m_tag = static_cast<tag_t>(meta::pack_index<E, events_t>::value);
+        return t_event;
+    }
+
+    /**
+     * \brief Создание события, при необходимости в блоке пула.
+     * \return указатель на созданное событие или nullptr, если пул исчерпан (конверт остаётся пустым).
+     */
+    template <class E, class... Args> requires has_event<E>
+    E *emplace(event_pool_base &pool, Args&&... args) noexcept {
+        if constexpr (fits_inline<E>) {
+            return emplace<E>(std::forward<Args>(args)...);
+        }
+        else {
+            reset();
+            void *t_block = pool.allocate(sizeof(E), alignof(E));
+            if (t_block == nullptr)
+                return nullptr;
+            auto *t_event = ::new (t_block) E{std::forward<Args>(args)...};
+            ::new (static_cast<void*>(m_storage)) void*{t_block};
+            m_pool = &pool;
+            m_tag = static_cast<tag_t>(meta::pack_index<E, events_t>::value);
+            return t_event;
+        }
+    }
+
+    // уничтожение хранимого события
+    void reset() noexcept {
+        if (empty())
+            return;
+        destroy(m_tag, data(), std::make_index_sequence<count>{});
+        if (m_pool != nullptr)
+            m_pool->deallocate(data());
+        m_pool = nullptr;
+        m_tag = empty_tag;
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return m_tag == empty_tag; }
+
+    // порядковый номер типа хранимого события в списке событий таблицы переходов
+    [[nodiscard]] std::size_t index() const noexcept { return m_tag; }
+
+    template <class E>
+    [[nodiscard]] bool holds() const noexcept {
+        return m_tag == meta::pack_index<E, events_t>::value;
+    }
+
+    template <class E>
+    [[nodiscard]] E *get_if() noexcept {
+        return holds<E>() ? static_cast<E*>(data()) : nullptr;
+    }
+
+    /**
+     * \brief Вызов функтора для хранимого события через таблицу по тегу.
+     * Конверт не должен быть пустым.
+     */
+    template <class F>
+    decltype(auto) visit(F &&visitor) {
+        return dispatch(m_tag, data(), visitor, std::make_index_sequence<count>{});
+    }
+
+private:
+    void *data() noexcept {
+        return m_pool != nullptr ? *std::launder(reinterpret_cast<void**>(m_storage)) : static_cast<void*>(m_storage);
+    }
+
+    void take(event_envelope &other) noexcept {
+        if (other.empty())
+            return;
+        if (other.m_pool != nullptr)
+            ::new (static_cast<void*>(m_storage)) void*{other.data()};
+        else
+            relocate(other.m_tag, m_storage, other.data(), std::make_index_sequence<count>{});
+        m_pool = other.m_pool;
+        m_tag = other.m_tag;
+        other.m_pool = nullptr;
+        other.m_tag = empty_tag;
+    }
+
+    template <class E>
+    static void destroy_one(void *event) noexcept {
+        static_cast<E*>(event)->~E();
+    }
+
+    template <class E>
+    static void relocate_one(void *dst, void *src) noexcept {
+        if constexpr (fits_inline<E>) {
+            ::new (dst) E{std::move(*static_cast<E*>(src))};
+            static_cast<E*>(src)->~E();
+        }
+    }
+
+    template <class E, class F>
+    static decltype(auto) visit_one(void *event, F &visitor) {
+        return visitor(*static_cast<E*>(event));
+    }
+
+    template <std::size_t... I>
+    static void destroy(std::size_t tag, void *event, std::index_sequence<I...>) noexcept {
+        static constexpr void (*table[])(void*) noexcept = {&destroy_one<meta::pack_element_t<I, events_t>>...};
+        table[tag](event);
+    }
+
+    template <std::size_t... I>
+    static void relocate(std::size_t tag, void *dst, void *src, std::index_sequence<I...>) noexcept {
+        static constexpr void (*table[])(void*, void*) noexcept = {&relocate_one<meta::pack_element_t<I, events_t>>...};
+        table[tag](dst, src);
+    }
+
+    template <class F, std::size_t... I>
+    static decltype(auto) dispatch(std::size_t tag, void *event, F &visitor, std::index_sequence<I...>) {
+        using result_t = decltype(visit_one<meta::pack_element_t<0, events_t>>(event, visitor));
+        static constexpr result_t (*table[])(void*, F&) = {&visit_one<meta::pack_element_t<I, events_t>, F>...};
+        return table[tag](event, visitor);
+    }
+
+    alignas(std::max_align_t) std::byte m_storage[InlineSize];
+    event_pool_base *m_pool {nullptr};
+    tag_t m_tag {empty_tag};
+};
+
+template <class T>
+struct is_event_envelope : std::false_type {};
+
+template <class Table, std::size_t InlineSize>
+struct is_event_envelope<event_envelope<Table, InlineSize>> : std::true_type {};
+
+template <class T>
+concept IsEventEnvelope = is_event_envelope<std::remove_cvref_t<T>>::value;
+
+}
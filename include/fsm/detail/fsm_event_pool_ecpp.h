@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace ecpp::fsm {
+
+/**
+ * \class event_pool_base
+ * \brief Пул блоков фиксированного размера для событий, не помещающихся во встроенный буфер event_envelope.
+ * Память под блоки предоставляет наследник, свободные блоки связаны в интрузивный список,
+ * поэтому выделение и освобождение не обращаются к куче.
+ */
+class event_pool_base {
+public:
+    event_pool_base(const event_pool_base&) = delete;
+    event_pool_base& operator=(const event_pool_base&) = delete;
+
+    /**
+     * \brief Выделение блока.
+     * \return указатель на блок или nullptr, если пул исчерпан либо блок слишком мал для запрошенного размера.
+     */
+    [[nodiscard]] void *allocate(std::size_t size, std::size_t align) noexcept {
+        if (size > m_block_size || align > alignof(std::max_align_t) || m_free == nullptr)
+            return nullptr;
+        auto *t_block = m_free;
+        m_free = t_block->next;
+        return t_block;
+    }
+
+    /**
+     * \brief Возврат блока в пул.
+     * \param block - указатель, ранее полученный из allocate() этого же пула.
+     */
+    void deallocate(void *block) noexcept {
+        m_free = ::new (block) free_block{m_free};
+    }
+
+    [[nodiscard]] std::size_t block_size() const noexcept { return m_block_size; }
+
+protected:
+    event_pool_base() noexcept = default;
+    ~event_pool_base() = default;
+
+    // размечаем предоставленную память в список свободных блоков
+    void assign(std::byte *storage, std::size_t block_size, std::size_t block_count) noexcept {
+        m_block_size = block_size;
+        for (std::size_t i {block_count}; i > 0; --i)
+            deallocate(storage + (i - 1) * block_size);
+    }
+
+private:
+    struct free_block { free_block *next; };
+
+    free_block *m_free {nullptr};
+    std::size_t m_block_size {0};
+};
+
+/**
+ * \class event_pool
+ * \brief Пул на BlockCount блоков по BlockSize байт, размещённый внутри самого объекта.
+ */
+template <std::size_t BlockSize, std::size_t BlockCount>
+class event_pool final : public event_pool_base {
+    // размер блока выравниваем так, чтобы каждый блок был выровнен как std::max_align_t
+    static constexpr std::size_t block_size = (BlockSize + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+    static_assert(BlockCount > 0, "event_pool must contain at least one block");
+    static_assert(block_size >= sizeof(void*), "event_pool block is too small");
+
+public:
+    event_pool() noexcept {
+        assign(m_storage, block_size, BlockCount);
+    }
+
+private:
+    alignas(std::max_align_t) std::byte m_storage[block_size * BlockCount];
+};
+
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <concepts>
+#include <type_traits>
+#include <utility>
+
+#include "fsm_meta_lib_ecpp.h"
+#include "fsm_action_ecpp.h"
+#include "fsm_guard_ecpp.h"
+#include "fsm_transition_ecpp.h"
+
+namespace ecpp::fsm {
+
+// действия и guard, экземпляры которых хранятся в автомате
+template <class X>
+struct is_stored_functor : std::bool_constant<std::is_class_v<X> && !std::is_same_v<X, none>> {};
+
+template <auto Member>
+struct is_stored_functor<member<Member>> : std::false_type {};
+
+template <class... G>
+struct guard_leaves<meta::type_pack<G...>> : meta::unique_of<meta::concat_t<meta::type_pack<>, typename guard_leaves<G>::type...>> {};
+
+template <class... Tables>
+struct functors_of : meta::unique_of<meta::filter_t<is_stored_functor, meta::concat_t<meta::type_pack<>,
+                        typename Tables::actions_t...,
+                        typename guard_leaves<typename Tables::guards_t>::type...>>> {};
+
+// экземпляр хранится, если у функтора есть состояние либо он создаётся из определения автомата,
+// пустые функторы создаются временными объектами в месте вызова
+template <class T>
+struct keeps_functor {
+    template <class X>
+    struct test : std::bool_constant<!std::is_empty_v<X> || std::constructible_from<X, T&>> {};
+};
+
+template <class T, class... Tables>
+struct table_functors;
+
+template <class T, class Table, class... Tables>
+struct table_functors<T, Table, meta::type_pack<Tables...>>
+        : std::type_identity<meta::filter_t<keeps_functor<T>::template test, typename functors_of<Table, Tables...>::type>> {};
+
+// создание экземпляра: функторы, принимающие определение автомата, получают ссылку на него
+template <class X, class F>
+constexpr X make_functor(F &fsm) noexcept {
+    if constexpr (std::constructible_from<X, F&>)
+        return X{fsm};
+    else
+        return X{};
+}
+
+// копия для нового автомата: функторы, созданные из определения, создаются заново из его копии
+template <class X, class F>
+constexpr X copy_functor(const X &other, F &fsm) noexcept {
+    if constexpr (std::constructible_from<X, F&>)
+        return X{fsm};
+    else
+        return other;
+}
+
+/**
+ * \class functor_leaf
+ * \brief Экземпляр действия или guard, созданный вместе с автоматом.
+ * Функтор хранится членом, а не базовым классом, чтобы его имена не смешивались с именами определения автомата.
+ */
+template <class X>
+struct functor_leaf {
+    template <class F>
+    constexpr explicit functor_leaf(F &fsm) noexcept : m_functor{make_functor<X>(fsm)} {}
+
+    template <class F>
+    constexpr functor_leaf(const functor_leaf &other, F &fsm) noexcept : m_functor{copy_functor<X>(other.m_functor, fsm)} {}
+
+    X m_functor;
+};
+
+/**
+ * \class functor_storage
+ * \brief Кортеж экземпляров действий и guard таблицы переходов, доступ к которым выполняется по типу.
+ * Каждый экземпляр создаётся один раз при создании автомата и вызывается по ссылке.
+ */
+template <class P>
+struct functor_storage;
+
+template <class... Xs>
+struct functor_storage<meta::type_pack<Xs...>> : functor_leaf<Xs>... {
+    constexpr functor_storage() noexcept = default;
+
+    template <class F>
+    constexpr explicit functor_storage(F &fsm) noexcept : functor_leaf<Xs>{fsm}... {}
+
+    template <class F>
+    constexpr functor_storage(const functor_storage &other, F &fsm) noexcept
+        : functor_leaf<Xs>{static_cast<const functor_leaf<Xs>&>(other), fsm}... {}
+
+    template <class X>
+    static constexpr bool contains = meta::contains<X>(meta::type_pack<Xs...>{});
+
+    template <class X> requires contains<X>
+    constexpr X &get() noexcept {
+        return static_cast<functor_leaf<X>&>(*this).m_functor;
+    }
+
+    template<class A, class E, class F, class S, class D>
+    constexpr decltype(auto) action(const E &event, F &fsm, S &src, D &dst) noexcept {
+        if constexpr (contains<A>)
+            return call_action<A>{}(get<A>(), event, fsm, src, dst);
+        else
+            return call_action<A>{}(event, fsm, src, dst);
+    }
+
+    template<class G, class E, class F, class S>
+    constexpr bool guard(const E &event, const F &fsm, const S &src) noexcept {
+        if constexpr (contains<G>)
+            return call_guard<G>{}(get<G>(), event, fsm, src);
+        else
+            return call_guard<G>{}(event, fsm, src);
+    }
+};
+
+// хранилище действий и guard таблицы переходов определения T, включая внутренние переходы состояний
+template <class T>
+using functor_storage_t = functor_storage<typename table_functors<T, typename T::transitions,
+                                                                 typename T::transitions::internal_transitions>::type>;
+
+/**
+ * \class machine_data
+ * \brief Текущее состояние автомата вместе с хранилищем функторов.
+ * Если хранить нечего, хранилище не занимает места: оно создаётся временным объектом при каждом обращении.
+ * \tparam Mark - пустой либо хранящий признак копии базовый класс, см. fork_mark.
+ */
+template <class States, class Storage, class Mark>
+struct machine_data : Mark {
+    template <class F>
+    constexpr machine_data(States current, F &fsm) noexcept : m_current{std::move(current)}, m_functors{fsm} {}
+
+    template <class F>
+    constexpr machine_data(const machine_data &other, F &fsm) noexcept : m_current{other.m_current}, m_functors{other.m_functors, fsm} {}
+
+    constexpr Storage &functors() noexcept { return m_functors; }
+
+    States m_current;
+    Storage m_functors;
+};
+
+template <class States, class Mark>
+struct machine_data<States, functor_storage<meta::type_pack<>>, Mark> : Mark {
+    template <class F>
+    constexpr machine_data(States current, F &) noexcept : m_current{std::move(current)} {}
+
+    template <class F>
+    constexpr machine_data(const machine_data &other, F &) noexcept : m_current{other.m_current} {}
+
+    static constexpr functor_storage<meta::type_pack<>> functors() noexcept { return {}; }
+
+    States m_current;
+};
+
+}
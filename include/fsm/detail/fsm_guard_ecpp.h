@@ -1,9 +1,12 @@
 #pragma once
 
 #include <concepts>
+#include <cstdint>
 #include <functional>
 #include <type_traits>
 
+#include "fsm_meta_lib_ecpp.h"
+
 namespace ecpp::fsm {
 
 template<class G, class E, class F, class S>
@@ -16,82 +19,275 @@ concept CallGuardShort = requires(G guard, E event, F fsm) {
     { guard(event, fsm) } -> std::convertible_to<bool>;
 };
 
+// базовый класс "чистого" guard: результат зависит только от события, контекста и состояния,
+// поэтому в пределах обработки одного события он вычисляется не более одного раза
+struct pure_guard {};
+
+/**
+ * \class member
+ * \brief Guard, хранящийся как член определения автомата, вместо создаваемого на каждый вызов временного объекта.
+ * operator() guard-члена должен быть const, изменяемое состояние объявляется mutable.
+ * \tparam Member - указатель на член определения, например &luggage_storage_def::m_validator.
+ */
+template <auto Member> requires std::is_member_object_pointer_v<decltype(Member)>
+struct member {};
+
+template <class G>
+struct is_pure_guard : std::is_base_of<pure_guard, G> {};
+
+template <class C, class M, M C::*Member>
+struct is_pure_guard<member<Member>> : std::is_base_of<pure_guard, M> {};
+
+template <class G>
+concept IsPureGuard = is_pure_guard<G>::value;
+
 template  <class G>
 struct call_guard {
+    template<class E, class F, class S> requires CallGuard<G&, E, F, S>
+    constexpr bool operator()(G &guard, const E &event, const F &fsm, const S &src) const noexcept {
+        return guard(event, fsm, src);
+    }
+
+    template<class E, class F, class S> requires CallGuardShort<G&, E, F>
+    constexpr bool operator()(G &guard, const E &event, const F &fsm, const S &) const noexcept {
+        return guard(event, fsm);
+    }
+
+    template<class E, class F, class S>
+    constexpr bool operator()(G&, const E &, const F &, const S &) const noexcept {
+        return true;
+    }
+
     template<class E, class F, class S> requires CallGuard<G, E, F, S>
-    bool operator()(const E &event, const F &fsm, const S &src) const noexcept {
+    constexpr bool operator()(const E &event, const F &fsm, const S &src) const noexcept {
         return G{}(event, fsm, src);
     }
 
     template<class E, class F, class S> requires CallGuardShort<G, E, F>
-    bool operator()(const E &event, const F &fsm, const S &) const noexcept {
+    constexpr bool operator()(const E &event, const F &fsm, const S &) const noexcept {
         return G{}(event, fsm);
     }
 
     template<class E, class F, class S>
-    bool operator()(const E &, const F &, const S &) const noexcept {
+    constexpr bool operator()(const E &, const F &, const S &) const noexcept {
         return true;
     }
 };
 
-template  <class G>
-struct not_ {
-    template<class E, class F, class S> requires CallGuard<G, E, F, S>
-    bool operator()(const E &event, const F &fsm, const S &src) const noexcept {
-        return !G{}(event, fsm, src);
+template <class C, class M, M C::*Member>
+struct call_guard<member<Member>> {
+    template<class E, class F, class S> requires CallGuard<const M&, E, F, S>
+    constexpr bool operator()(const E &event, const F &fsm, const S &src) const noexcept {
+        return (fsm.*Member)(event, fsm, src);
     }
 
-    template<class E, class F, class S> requires CallGuardShort<G, E, F>
-    bool operator()(const E &event, const F &fsm, const S &) const noexcept {
-        return !G{}(event, fsm);
+    template<class E, class F, class S> requires CallGuardShort<const M&, E, F>
+    constexpr bool operator()(const E &event, const F &fsm, const S &) const noexcept {
+        return (fsm.*Member)(event, fsm);
     }
 
+    // guard-член вызывается через константную ссылку на определение, поэтому его operator() должен быть const,
+    // изменяемое состояние (например, кеш) хранится в mutable членах
     template<class E, class F, class S>
-    bool operator()(const E &, const F &, const S &) const noexcept {
+    constexpr bool operator()(const E &, const F &, const S &) const noexcept {
+        static_assert(CallGuard<const M&, E, F, S> || CallGuardShort<const M&, E, F>,
+                      "member guard must be const-callable as guard(event, fsm) or guard(event, fsm, src), keep mutable state in mutable members");
         return false;
     }
 };
 
-template <class... G>
-struct and_ {
-    template<class E, class F, class S> requires ((CallGuard<call_guard<G>, E, F, S>) && ...)
-    bool operator()(const E &event, const F &fsm, const S &src) const noexcept {
-        return (call_guard<G>{}(event, fsm, src) && ...);
+template <class G>
+struct check_guard;
+
+template  <class G>
+struct not_ {
+    template<class E, class F, class S>
+    constexpr bool operator()(const E &event, const F &fsm, const S &src) const noexcept {
+        return check_guard<not_>{}(event, fsm, src);
     }
+};
 
+template <class... G>
+struct and_ {
     template<class E, class F, class S>
-    bool operator()(const E &, const F &, const S &) const noexcept {
-        return true;
+    constexpr bool operator()(const E &event, const F &fsm, const S &src) const noexcept {
+        return check_guard<and_>{}(event, fsm, src);
     }
 };
 
 template <>
 struct and_<> {
     template <class... Args>
-    bool operator()(Args&&...) const noexcept {
+    constexpr bool operator()(Args&&...) const noexcept {
         return false;
     }
 };
 
 template <class... G>
 struct or_ {
-    template<class E, class F, class S> requires ((CallGuard<call_guard<G>, E, F, S>) && ...)
-    bool operator()(const E &event, const F &fsm, const S &src) const noexcept {
-        return (call_guard<G>{}(event, fsm, src) || ...);
+    template<class E, class F, class S>
+    constexpr bool operator()(const E &event, const F &fsm, const S &src) const noexcept {
+        return check_guard<or_>{}(event, fsm, src);
     }
+};
 
-    template<class E, class F, class S>
-    bool operator()(const E &, const F &, const S &) const noexcept {
+template <>
+struct or_<> {
+    template <class... Args>
+    constexpr bool operator()(Args&&...) const noexcept {
         return true;
     }
 };
 
+// список уникальных "чистых" guard, входящих в выражение
+template <class G>
+struct pure_guards : std::type_identity<std::conditional_t<IsPureGuard<G>, meta::type_pack<G>, meta::type_pack<>>> {};
+
+template <class G>
+struct pure_guards<not_<G>> : pure_guards<G> {};
+
+template <class... G>
+struct pure_guards<and_<G...>> : meta::unique_of<meta::concat_t<meta::type_pack<>, typename pure_guards<G>::type...>> {};
+
+template <class... G>
+struct pure_guards<or_<G...>> : meta::unique_of<meta::concat_t<meta::type_pack<>, typename pure_guards<G>::type...>> {};
+
+// список уникальных guard, из которых состоит выражение
+template <class G>
+struct guard_leaves : std::type_identity<meta::type_pack<G>> {};
+
+template <class G>
+struct guard_leaves<not_<G>> : guard_leaves<G> {};
+
+template <class... G>
+struct guard_leaves<and_<G...>> : meta::unique_of<meta::concat_t<meta::type_pack<>, typename guard_leaves<G>::type...>> {};
+
+template <class... G>
+struct guard_leaves<or_<G...>> : meta::unique_of<meta::concat_t<meta::type_pack<>, typename guard_leaves<G>::type...>> {};
+
+/**
+ * \class guard_cache
+ * \brief Результаты "чистых" guard, вычисленные в ходе обработки одного события.
+ */
+template <class P>
+struct guard_cache;
+
+template <class... G>
+struct guard_cache<meta::type_pack<G...>> {
+    template <class U, class Fn>
+    constexpr bool get(Fn &&fn) noexcept {
+        constexpr auto index = meta::find<U, G...>();
+        if (m_values[index] == unknown)
+            m_values[index] = fn() ? yes : no;
+        return m_values[index] == yes;
+    }
+
+private:
+    enum : std::uint8_t { unknown, no, yes };
+    std::uint8_t m_values[sizeof...(G)] {};
+};
+
 template <>
-struct or_<> {
+struct guard_cache<meta::type_pack<>> {
+    template <class U, class Fn>
+    constexpr bool get(Fn &&fn) noexcept {
+        return fn();
+    }
+};
+
+template <class G>
+using guard_cache_t = guard_cache<typename pure_guards<G>::type>;
+
+// guard создаются временными объектами на каждый вызов
+struct temporary_guards {
+    template<class G, class E, class F, class S>
+    constexpr bool guard(const E &event, const F &fsm, const S &src) noexcept {
+        return call_guard<G>{}(event, fsm, src);
+    }
+};
+
+/**
+ * \class eval_guard
+ * \brief Вычисление выражения guard: одинаковые guard в and_<>/or_<> вычисляются один раз,
+ * результаты "чистых" guard берутся из кеша.
+ */
+template <class G>
+struct eval_guard {
+    template<class E, class F, class S, class C, class Fs>
+    constexpr bool operator()(const E &event, const F &fsm, const S &src, C &cache, Fs &functors) const noexcept {
+        if constexpr (IsPureGuard<G>)
+            return cache.template get<G>([&]() noexcept { return functors.template guard<G>(event, fsm, src); });
+        else
+            return functors.template guard<G>(event, fsm, src);
+    }
+};
+
+template <class G>
+struct eval_guard<not_<G>> {
+    template<class E, class F, class S, class C, class Fs>
+    constexpr bool operator()(const E &event, const F &fsm, const S &src, C &cache, Fs &functors) const noexcept {
+        return !eval_guard<G>{}(event, fsm, src, cache, functors);
+    }
+};
+
+template <class... G>
+struct eval_guard<and_<G...>> {
+    template<class E, class F, class S, class C, class Fs>
+    constexpr bool operator()(const E &event, const F &fsm, const S &src, C &cache, Fs &functors) const noexcept {
+        return all(event, fsm, src, cache, functors, meta::unique_type_pack<G...>{});
+    }
+
+private:
+    template<class E, class F, class S, class C, class Fs, class... U>
+    static constexpr bool all(const E &event, const F &fsm, const S &src, C &cache, Fs &functors, meta::type_pack<U...>) noexcept {
+        return (eval_guard<U>{}(event, fsm, src, cache, functors) && ...);
+    }
+};
+
+template <>
+struct eval_guard<and_<>> {
+    template <class... Args>
+    constexpr bool operator()(Args&&...) const noexcept {
+        return false;
+    }
+};
+
+template <class... G>
+struct eval_guard<or_<G...>> {
+    template<class E, class F, class S, class C, class Fs>
+    constexpr bool operator()(const E &event, const F &fsm, const S &src, C &cache, Fs &functors) const noexcept {
+        return any(event, fsm, src, cache, functors, meta::unique_type_pack<G...>{});
+    }
+
+private:
+    template<class E, class F, class S, class C, class Fs, class... U>
+    static constexpr bool any(const E &event, const F &fsm, const S &src, C &cache, Fs &functors, meta::type_pack<U...>) noexcept {
+        return (eval_guard<U>{}(event, fsm, src, cache, functors) || ...);
+    }
+};
+
+template <>
+struct eval_guard<or_<>> {
     template <class... Args>
-    bool operator()(Args&&...) const noexcept {
+    constexpr bool operator()(Args&&...) const noexcept {
         return true;
     }
 };
 
+// вычисление выражения guard с собственным кешем на время одного вызова
+template <class G>
+struct check_guard {
+    template<class E, class F, class S, class Fs>
+    constexpr bool operator()(const E &event, const F &fsm, const S &src, Fs &&functors) const noexcept {
+        guard_cache_t<G> t_cache;
+        return eval_guard<G>{}(event, fsm, src, t_cache, functors);
+    }
+
+    template<class E, class F, class S>
+    constexpr bool operator()(const E &event, const F &fsm, const S &src) const noexcept {
+        temporary_guards t_guards;
+        return (*this)(event, fsm, src, t_guards);
+    }
+};
+
 }
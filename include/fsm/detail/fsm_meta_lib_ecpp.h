@@ -3,6 +3,7 @@
 #include <type_traits>
 #include <variant>
 #include <array>
+#include <string_view>
 
 namespace ecpp::fsm::meta {
 
@@ -79,5 +80,109 @@ struct non_void<type_pack<Ts...>, U, Us...>
 template <typename... Ts>
 using non_void_type_pack = typename non_void<type_pack<>, Ts...>::type;
 
+
+// формирование списка уникальных типов
+template <typename T, typename... Ts>
+struct unique_pack : std::type_identity<T> {};
+
+template <typename... Ts, typename U, typename... Us>
+struct unique_pack<type_pack<Ts...>, U, Us...>
+        : std::conditional_t<(std::is_same_v<U, Ts> || ...)
+                , unique_pack<type_pack<Ts...>, Us...>
+                , unique_pack<type_pack<Ts..., U>, Us...>> {};
+
+template <typename... Ts>
+using unique_type_pack = typename unique_pack<type_pack<>, Ts...>::type;
+
+template <class P>
+struct unique_of;
+
+template <class... Ts>
+struct unique_of<type_pack<Ts...>> : std::type_identity<unique_type_pack<Ts...>> {};
+
+template <class P>
+using unique_of_t = typename unique_of<P>::type;
+
+
+// объединение нескольких списков типов в один
+template <class... Ps>
+struct concat : std::type_identity<type_pack<>> {};
+
+template <class... Ts>
+struct concat<type_pack<Ts...>> : std::type_identity<type_pack<Ts...>> {};
+
+template <class... Ts, class... Us, class... Ps>
+struct concat<type_pack<Ts...>, type_pack<Us...>, Ps...> : concat<type_pack<Ts..., Us...>, Ps...> {};
+
+template <class... Ps>
+using concat_t = typename concat<Ps...>::type;
+
+
+// количество типов в списке
+template <class P>
+struct pack_size;
+
+template <class... Ts>
+struct pack_size<type_pack<Ts...>> : std::integral_constant<std::size_t, sizeof...(Ts)> {};
+
+// тип из списка по его порядковому номеру
+template <std::size_t N, class P>
+struct pack_element;
+
+template <std::size_t N, class... Ts>
+struct pack_element<N, type_pack<Ts...>> : get_type_by_index<N, Ts...> {};
+
+template <std::size_t N, class P>
+using pack_element_t = typename pack_element<N, P>::type;
+
+// порядковый номер типа в списке (или размер списка, если тип отсутствует)
+template <class T, class P>
+struct pack_index;
+
+template <class T, class... Ts>
+struct pack_index<T, type_pack<Ts...>> : std::integral_constant<std::size_t, find<T, Ts...>()> {};
+
+template <class T>
+struct pack_index<T, type_pack<>> : std::integral_constant<std::size_t, 0> {};
+
+// формирование списка типов, удовлетворяющих предикату
+template <template <class> class Pred, class P>
+struct filter;
+
+template <template <class> class Pred, class... Ts>
+struct filter<Pred, type_pack<Ts...>>
+        : concat<type_pack<>, std::conditional_t<Pred<Ts>::value, type_pack<Ts>, type_pack<>>...> {};
+
+template <template <class> class Pred, class P>
+using filter_t = typename filter<Pred, P>::type;
+
+// список альтернатив std::variant
+template <class V>
+struct variant_pack;
+
+template <class... Ts>
+struct variant_pack<std::variant<Ts...>> : std::type_identity<type_pack<Ts...>> {};
+
+// имя типа, извлекаемое из сигнатуры функции, сформированной компилятором
+template <class T>
+constexpr std::string_view type_name() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+    std::string_view t_name {__FUNCSIG__};
+    const auto t_begin = t_name.find("type_name<") + 10;
+    t_name = t_name.substr(t_begin, t_name.rfind(">(void)") - t_begin);
+    for (std::string_view t_prefix : {"struct ", "class ", "enum "}) {
+        if (t_name.starts_with(t_prefix))
+            t_name.remove_prefix(t_prefix.size());
+    }
+    return t_name;
+#else
+    std::string_view t_name {__PRETTY_FUNCTION__};
+    const auto t_begin = t_name.find("T = ") + 4;
+    auto t_end = t_name.find(';', t_begin);
+    if (t_end == std::string_view::npos)
+        t_end = t_name.rfind(']');
+    return t_name.substr(t_begin, t_end - t_begin);
+#endif
 }
 
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "fsm_meta_lib_ecpp.h"
+
+namespace ecpp::fsm {
+
+// политика по умолчанию: без профилирования
+struct no_profile {};
+
+// политика подсчёта частот пар (состояние, событие) для последующей генерации профиля
+struct profile_counter {};
+
+/**
+ * \struct hit
+ * \brief Частота обработки события Event в состоянии State.
+ */
+template <class State, class Event, std::uint64_t Count>
+struct hit {
+    using state_t = State;
+    using event_t = Event;
+    static constexpr std::uint64_t count = Count;
+};
+
+/**
+ * \struct profile
+ * \brief Профиль частот, сгенерированный state_machine<T, profile_counter>::write_profile().
+ * Используется как политика автомата: состояния и ветви диспетчеризации упорядочиваются от частых к редким.
+ */
+template <class... Hits>
+struct profile {
+    template <class S, class E>
+    static constexpr std::uint64_t hits() noexcept {
+        return (std::uint64_t{0} + ... + ((std::is_same_v<S, typename Hits::state_t> && std::is_same_v<E, typename Hits::event_t>) ? Hits::count : 0));
+    }
+
+    template <class S>
+    static constexpr std::uint64_t state_hits() noexcept {
+        return (std::uint64_t{0} + ... + (std::is_same_v<S, typename Hits::state_t> ? Hits::count : 0));
+    }
+};
+
+template <class P>
+struct is_profile : std::false_type {};
+
+template <class... Hits>
+struct is_profile<profile<Hits...>> : std::true_type {};
+
+template <class P>
+concept IsProfile = is_profile<P>::value;
+
+namespace meta {
+
+// устойчивая сортировка списка типов по убыванию веса Weight<T>::value
+template <template <class> class Weight, class P>
+struct sort_desc;
+
+template <template <class> class Weight, class... Ts>
+struct sort_desc<Weight, type_pack<Ts...>> {
+private:
+    static constexpr auto order = [] {
+        constexpr std::array<std::uint64_t, sizeof...(Ts)> t_weights {Weight<Ts>::value...};
+        std::array<std::size_t, sizeof...(Ts)> t_order {};
+        for (std::size_t i {0}; i < t_order.size(); ++i) {
+            std::size_t j {i};
+            for (; j > 0 && t_weights[t_order[j - 1]] < t_weights[i]; --j)
+                t_order[j] = t_order[j - 1];
+            t_order[j] = i;
+        }
+        return t_order;
+    }();
+
+    template <std::size_t... I>
+    static auto make(std::index_sequence<I...>) -> type_pack<get_type_from_index<order[I], Ts...>...>;
+
+public:
+    using type = decltype(make(std::make_index_sequence<sizeof...(Ts)>{}));
+};
+
+template <template <class> class Weight>
+struct sort_desc<Weight, type_pack<>> : std::type_identity<type_pack<>> {};
+
+template <template <class> class Weight, class P>
+using sort_desc_t = typename sort_desc<Weight, P>::type;
+
+template <class P>
+struct to_variant;
+
+template <class... Ts>
+struct to_variant<type_pack<Ts...>> : std::type_identity<std::variant<Ts...>> {};
+
+}
+
+/**
+ * \class profile_storage
+ * \brief Данные политики профилирования, хранимые в автомате.
+ */
+template <class Policy, std::size_t States, std::size_t Events>
+struct profile_storage {
+    static constexpr void count(std::size_t, std::size_t) noexcept {}
+};
+
+template <std::size_t States, std::size_t Events>
+struct profile_storage<profile_counter, States, Events> {
+    constexpr void count(std::size_t state, std::size_t event) noexcept {
+        ++m_hits[state * Events + event];
+    }
+
+    std::array<std::uint64_t, States * Events> m_hits {};
+};
+
+}
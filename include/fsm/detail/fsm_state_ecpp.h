@@ -38,30 +38,30 @@ concept CallShortOnExit = requires(S state, F fsm) {
 
 struct call_on_entry {
     template<class State, class FSM, class E> requires CallOnEntry<State, E, FSM>
-    void operator()(State &state, const E &event, FSM &fsm) const noexcept { state.on_entry(event, fsm); }
+    constexpr void operator()(State &state, const E &event, FSM &fsm) const noexcept { state.on_entry(event, fsm); }
 
     template<class State, class FSM, class E>
-    void operator()(State &state, const E &e, FSM &fsm) const noexcept {}
+    constexpr void operator()(State &state, const E &e, FSM &fsm) const noexcept {}
 
     template<class State, class FSM> requires CallShortOnEntry<State, FSM>
-    void operator()(State &state, FSM &fsm) const noexcept { state.on_entry(fsm); }
+    constexpr void operator()(State &state, FSM &fsm) const noexcept { state.on_entry(fsm); }
 
     template<class State, class FSM>
-    void operator()(State &state, FSM &fsm) const noexcept {}
+    constexpr void operator()(State &state, FSM &fsm) const noexcept {}
 };
 
 struct call_on_exit {
     template<class State, class FSM, class E> requires CallOnExit<State, E, FSM>
-    void operator()(State &state, const E &event, FSM &fsm) const noexcept { state.on_exit(event, fsm); }
+    constexpr void operator()(State &state, const E &event, FSM &fsm) const noexcept { state.on_exit(event, fsm); }
 
     template<class State, class FSM, class E>
-    void operator()(State &state, const E &e, FSM &fsm) const noexcept {}
+    constexpr void operator()(State &state, const E &e, FSM &fsm) const noexcept {}
 
     template<class State, class FSM> requires CallShortOnExit<State, FSM>
-    void operator()(State &state, FSM &fsm) const noexcept { state.on_exit(fsm); }
+    constexpr void operator()(State &state, FSM &fsm) const noexcept { state.on_exit(fsm); }
 
     template<class State, class FSM>
-    void operator()(State &state, FSM &fsm) const noexcept {}
+    constexpr void operator()(State &state, FSM &fsm) const noexcept {}
 };
 
 }
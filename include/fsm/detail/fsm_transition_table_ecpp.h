@@ -24,6 +24,9 @@ struct transition_table
     using all_states_t = meta::type_pack<typename T::source_t..., typename T::target_t...>;
     // извлекаем список всех событий из всех переходов
     using events_t = meta::type_pack<typename T::event_t...>;
+    // извлекаем типы всех действий и guard
+    using actions_t = meta::type_pack<typename T::action_t...>;
+    using guards_t = meta::type_pack<typename T::guard_t...>;
     // количество переходов
     static constexpr std::size_t count = sizeof...(T);
     // извлекаем все таблицы переходов определённые внутри состояний
@@ -69,6 +72,12 @@ struct transition_table
     struct has_event {
         static constexpr bool value = meta::contains<E>(events_t{}) || contains_in_table<E>(internal_transitions{});
     };
+
+    template <class... Tables>
+    static constexpr auto internal_events(meta::type_pack<Tables...>&&) noexcept -> meta::concat_t<meta::type_pack<>, typename Tables::events_t...>;
+
+    // список уникальных событий, включая события внутренних переходов
+    using all_events_t = meta::unique_of_t<meta::concat_t<events_t, decltype(internal_events(internal_transitions{}))>>;
 };
 
 
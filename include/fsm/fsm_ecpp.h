@@ -1,7 +1,9 @@
 #pragma once
 
-#include <iostream>
+#include <cstdio>
+#include <cstdint>
 #include <functional>
+#include <string_view>
 #include <type_traits>
 
 #include "detail/fsm_state_ecpp.h"
@@ -9,25 +11,67 @@
 #include "detail/fsm_guard_ecpp.h"
 #include "detail/fsm_transition_ecpp.h"
 #include "detail/fsm_transition_table_ecpp.h"
+#include "detail/fsm_event_envelope_ecpp.h"
+#include "detail/fsm_functors_ecpp.h"
+#include "detail/fsm_profile_ecpp.h"
+#include "detail/fsm_cow_ecpp.h"
 
 namespace ecpp::fsm {
 
 template <typename... Args>
 void print_types(Args... args) {
-    std::cout << __PRETTY_FUNCTION__ << std::endl;
+    std::puts(__PRETTY_FUNCTION__);
 }
 
+template <class Def, class Classes, bool SimdSkip>
+class scanner;
+
+// порядок альтернатив std::variant состояний
+template <class Policy, class States>
+struct state_order : std::type_identity<States> {};
+
+template <IsProfile Policy, class States>
+struct state_order<Policy, States> {
+    template <class S>
+    struct weight : std::integral_constant<std::uint64_t, Policy::template state_hits<S>()> {};
+
+    using type = typename meta::to_variant<meta::sort_desc_t<weight, typename meta::variant_pack<States>::type>>::type;
+};
+
+/**
+ * \class fork_mark
+ * \brief Признак копии, созданной fork(), которая ещё находится в унаследованном состоянии.
+ * Копия не входила в это состояние, поэтому и не выходит из него. Признак хранится, только если в автомате есть on_exit.
+ */
+template <bool Track>
+struct fork_mark {
+    constexpr bool inherited() const noexcept { return m_inherited; }
+    constexpr void inherit(bool value) noexcept { m_inherited = value; }
+
+private:
+    bool m_inherited {false};
+};
+
+template <>
+struct fork_mark<false> {
+    constexpr bool inherited() const noexcept { return false; }
+    constexpr void inherit(bool) noexcept {}
+};
+
 enum class result {
     refuse,
-    done
+    done,
+    failed
 };
 
 /**
  * \class state_machine
  * \brief Реализация автомата состояний
+ * Экземпляры действий и guard с состоянием хранятся в автомате и создаются один раз вместе с ним.
  * \tparam T - тип, реализующий определение состояний и таблицы переходов.
+ * \tparam Policy - политика профилирования: no_profile, profile_counter или сгенерированный profile<hit<...>...>.
  */
-template<class T> requires requires { typename T::transitions; typename T::initial_state; }
+template<class T, class Policy = no_profile> requires requires { typename T::transitions; typename T::initial_state; }
 struct state_machine : T {
     // извлекаем тип таблицы переходов
     using transitions_t = typename T::transitions;
@@ -35,109 +79,292 @@ struct state_machine : T {
     using initial_state_t = typename T::initial_state;
     // извлекаем все типы событий из таблицы переходов
     using events_t = typename transitions_t::events_t;
+    // std::variant всех состояний; при заданном профиле альтернативы упорядочены от частых к редким
+    using states_t = typename state_order<Policy, typename transitions_t::states_t>::type;
+    // конверт, способный хранить любое событие таблицы переходов
+    using event_envelope_t = event_envelope<transitions_t>;
 
     state_machine(const state_machine&) = delete;
     state_machine& operator=(const state_machine&) = delete;
 
-    state_machine() noexcept : T{} {
-        std::visit([&, fsm = static_cast<T&>(*this)](auto &t_current) {
+    constexpr state_machine() noexcept : T{} {
+        std::visit([&fsm = static_cast<T&>(*this)](auto &t_current) {
             call_on_entry{}(t_current, fsm);
-        }, m_current);
+        }, m_machine.m_current);
     }
 
     template <typename... Args>
     constexpr explicit state_machine(Args&&... args) noexcept : T{std::forward<Args>(args)...} {
-        std::visit([&, fsm = static_cast<T&>(*this)](auto &t_current) {
+        std::visit([&fsm = static_cast<T&>(*this)](auto &t_current) {
             call_on_entry{}(t_current, fsm);
-        }, m_current);
+        }, m_machine.m_current);
     }
 
-    ~state_machine() {
-        std::visit([&, fsm = static_cast<T&>(*this)](auto &t_current) {
-            call_on_exit{}(t_current, fsm);
-        }, m_current);
+    constexpr ~state_machine() {
+        // копия не выходит из унаследованного состояния, в которое она не входила
+        if (!m_machine.inherited()) {
+            std::visit([&fsm = static_cast<T&>(*this)](auto &t_current) {
+                call_on_exit{}(t_current, fsm);
+            }, m_machine.m_current);
+        }
+    }
+
+    /**
+     * \brief Создание независимой копии автомата в текущем состоянии.
+     * Копируются текущее состояние, данные определения и экземпляры действий и guard.
+     * Копия не вызывает on_entry унаследованного состояния и не вызывает его on_exit ни при переходе, ни при уничтожении,
+     * хуки всех состояний, в которые копия перешла сама, вызываются как обычно.
+     * Крупные данные определения, обёрнутые в cow<>, разделяются с копией до первого изменения.
+     */
+    [[nodiscard]] constexpr state_machine fork() const noexcept requires std::copy_constructible<T> {
+        return state_machine{fork_tag{}, *this};
     }
 
     /**
      * \brief Обработка события.
      * \tparam E - перемещаемый тип события, должен присутствовать в таблице переходов.
      * \param event - перемещаемая ссылка на сам объект события.
-     * \return результат выполнения.
+     * \return результат выполнения, result::failed - действие сообщило о неудаче и переход отменён.
      */
-    template<class E>
-    result process_event(E &&event) noexcept {
+    template<class E> requires (!IsEventEnvelope<E>)
+    constexpr result process_event(E &&event) noexcept {
         // проверка на этапе компиляции, что тип события содержится в таблице переходов
         static_assert(transitions_t::template has_event<E>::value, "unknown event type, this type is missing from the transition table!");
-        // задаём статус выполнения по умолчанию
+        using event_t = std::decay_t<E>;
+        // события, порождённые при обработке предыдущего события и не переданные конвейером дальше, отбрасываются
+        if constexpr (requires(T &t_def) { discard_outbox(t_def); })
+            discard_outbox(static_cast<T&>(*this));
+        // учитываем пару (состояние, событие) в политике профилирования
+        m_profile.count(m_machine.m_current.index(), meta::pack_index<event_t, typename transitions_t::all_events_t>::value);
+        if constexpr (IsProfile<Policy>) {
+            // проверяем только состояния, способные обработать событие, от частых к редким
+            using candidates_t = meta::filter_t<handles<event_t>::template in, typename meta::variant_pack<states_t>::type>;
+            using hot_t  = meta::sort_desc_t<hot_weight<event_t>::template of, meta::filter_t<hot_weight<event_t>::template is_hot, candidates_t>>;
+            using cold_t = meta::filter_t<hot_weight<event_t>::template is_cold, candidates_t>;
+            return dispatch_profiled(std::forward<E>(event), hot_t{}, cold_t{});
+        }
+        else {
+            // задаём статус выполнения по умолчанию
+            auto t_result {result::refuse};
+            // определяем текущее состояние
+            std::visit([&](auto &t_source) noexcept {
+                t_result = handle_event(t_source, std::forward<E>(event));
+            }, m_machine.m_current);
+            return t_result;
+        }
+    }
+
+    /**
+     * \brief Обработка события, упакованного в конверт.
+     * \param envelope - конверт с событием, тип события определяется по тегу конверта.
+     * \return результат выполнения, для пустого конверта - result::refuse.
+     */
+    template<IsEventEnvelope Envelope>
+    result process_event(Envelope &&envelope) noexcept {
+        static_assert(std::is_same_v<typename std::decay_t<Envelope>::transitions_t, transitions_t>, "envelope belongs to another transition table!");
+        if (envelope.empty())
+            return result::refuse;
+        return envelope.visit([this](auto &event) noexcept {
+            return process_event(std::move(event));
+        });
+    }
+
+    /**
+     * \brief Возвращает true если FSM находится в заданном состоянии, иначе вернёт false.
+     * \tparam State - тип состояния.
+     */
+    template <IsState State>
+    [[nodiscard]] constexpr bool is_in_state() const noexcept {
+        static_assert(meta::contains<State>(typename transitions_t::all_states_t{}), "the state is missing from the transitions table");
+        return std::holds_alternative<State>(m_machine.m_current);
+    }
+
+    /**
+     * \brief Количество событий E, поступивших в состоянии S (только для политики profile_counter).
+     */
+    template <IsState S, class E> requires std::is_same_v<Policy, profile_counter>
+    [[nodiscard]] constexpr std::uint64_t hits() const noexcept {
+        return m_profile.m_hits[meta::pack_index<S, typename meta::variant_pack<states_t>::type>::value * events_count
+                              + meta::pack_index<E, typename transitions_t::all_events_t>::value];
+    }
+
+    /**
+     * \brief Запись заголовочного файла с профилем частот, собранным политикой profile_counter.
+     * Сгенерированный профиль передаётся обратно как политика: state_machine<T, name>.
+     * \param out - поток вывода с operator<<, например std::ofstream.
+     * \param name - имя псевдонима типа профиля.
+     */
+    template <class Stream> requires std::is_same_v<Policy, profile_counter>
+    void write_profile(Stream &out, std::string_view name) const {
+        out << "#pragma once\n\n// generated by ecpp::fsm::state_machine<T, profile_counter>::write_profile()\n\n";
+        out << "using " << name << " = ecpp::fsm::profile<";
+        bool t_first {true};
+        [&]<std::size_t... S>(std::index_sequence<S...>) {
+            (write_hits<std::variant_alternative_t<S, states_t>>(out, t_first, std::make_index_sequence<events_count>{}), ...);
+        }(std::make_index_sequence<std::variant_size_v<states_t>>{});
+        out << "\n>;\n";
+    }
+
+private:
+    template <class Def, class Classes, bool SimdSkip>
+    friend class scanner;
+
+    struct fork_tag {};
+
+    constexpr state_machine(fork_tag, const state_machine &other) noexcept
+        : T{static_cast<const T&>(other)}
+        , m_profile{other.m_profile}
+        , m_machine{other.m_machine, static_cast<T&>(*this)} {
+        m_machine.inherit(true);
+    }
+
+    // есть ли у состояний on_exit, который копия должна пропустить
+    template <class S, class... E>
+    static constexpr bool exits(meta::type_pack<E...>) noexcept {
+        return CallShortOnExit<S, T&> || (CallOnExit<S, E, T&> || ...);
+    }
+
+    static constexpr bool has_on_exit = []<class... S>(std::type_identity<std::variant<S...>>) {
+        return (exits<S>(typename transitions_t::all_events_t{}) || ...);
+    }(std::type_identity<states_t>{});
+
+    static constexpr std::size_t events_count = meta::pack_size<typename transitions_t::all_events_t>::value;
+
+    template <class S, class Stream, std::size_t... E>
+    void write_hits(Stream &out, bool &first, std::index_sequence<E...>) const {
+        ([&] {
+            using event_t = meta::pack_element_t<E, typename transitions_t::all_events_t>;
+            const auto t_hits = hits<S, event_t>();
+            if (t_hits == 0)
+                return;
+            out << (first ? "\n    " : ",\n    ") << "ecpp::fsm::hit<" << meta::type_name<S>() << ", " << meta::type_name<event_t>() << ", " << t_hits << ">";
+            first = false;
+        }(), ...);
+    }
+
+    // состояние S обрабатывает событие E внешним или внутренним переходом
+    template <class E>
+    struct handles {
+        template <class S>
+        struct in : std::bool_constant<(transitions_t::template index_of<meta::type_pack<S, E>>() < transitions_t::count)> {};
+
+        template <class S> requires (!std::is_void_v<typename S::internal_transitions>)
+        struct in<S> : std::bool_constant<(transitions_t::template index_of<meta::type_pack<S, E>>() < transitions_t::count)
+                                       || (S::internal_transitions::template internal_index_of<E>() < S::internal_transitions::count)> {};
+    };
+
+    // частота пары (S, E) по профилю
+    template <class E>
+    struct hot_weight {
+        template <class S>
+        struct of : std::integral_constant<std::uint64_t, Policy::template hits<S, E>()> {};
+
+        template <class S>
+        struct is_hot : std::bool_constant<(of<S>::value > 0)> {};
+
+        template <class S>
+        struct is_cold : std::bool_constant<(of<S>::value == 0)> {};
+    };
+
+    // проверка кандидатов по порядку: сначала частые состояния, затем редкие
+    template <class E, class... Hot, class... Cold>
+    constexpr result dispatch_profiled(E &&event, meta::type_pack<Hot...>, meta::type_pack<Cold...>) noexcept {
         auto t_result {result::refuse};
+        const bool t_found = ((std::holds_alternative<Hot>(m_machine.m_current) ? (t_result = handle_event(*std::get_if<Hot>(&m_machine.m_current), std::forward<E>(event)), true) : false) || ...);
+        if (t_found) [[likely]]
+            return t_result;
+        static_cast<void>(((std::holds_alternative<Cold>(m_machine.m_current) ? (t_result = handle_event(*std::get_if<Cold>(&m_machine.m_current), std::forward<E>(event)), true) : false) || ...));
+        return t_result;
+    }
+
+    /**
+     * \brief Обработка события в текущем состоянии.
+     * \param t_source - ссылка на текущее состояние, хранимое в m_machine.m_current.
+     */
+    template <class S, class E>
+    constexpr result handle_event(S &t_source, E &&event) noexcept {
         // ссылка на контекст (принудительно определяем именно ссылку, что бы избежать неявного копирования)
         T &fsm = static_cast<T&>(*this);
-        // определяем текущее состояние
-        std::visit([&](auto &t_source) noexcept {
-            // извлекаем типы текущего состояния и события
-            using source_t = std::decay_t<decltype(t_source)>;
-            using event_t = std::decay_t<decltype(event)>;
-            // находим порядковый номер перехода, соответствующий текущему состоянию и входному событию
-            constexpr auto tr_index = transitions_t::template index_of<meta::type_pack<source_t,event_t>>();
-            if constexpr (tr_index < transitions_t::count) {
-                // создаём экземпляр перехода, для извлечения необходимых типов
-                using transition_t = typename transitions_t::template get_transition_type<tr_index>::type;
-                using guard_t  = typename transition_t::guard_t;
-                using action_t = typename transition_t::action_t;
-                using target_t = typename transition_t::target_t;
-                // проверяем, что GUARD разрешает переход
-                if (!call_guard<guard_t>{}(std::forward<E>(event), fsm, t_source))
-                    return;
-                // завершаем текущее состояние
+        // извлекаем типы текущего состояния и события
+        using source_t = S;
+        using event_t = std::decay_t<decltype(event)>;
+        // находим порядковый номер перехода, соответствующий текущему состоянию и входному событию
+        constexpr auto tr_index = transitions_t::template index_of<meta::type_pack<source_t,event_t>>();
+        if constexpr (tr_index < transitions_t::count) {
+            // создаём экземпляр перехода, для извлечения необходимых типов
+            using transition_t = typename transitions_t::template get_transition_type<tr_index>::type;
+            using guard_t  = typename transition_t::guard_t;
+            using action_t = typename transition_t::action_t;
+            using target_t = typename transition_t::target_t;
+            // результат проверяется только у действий, унаследованных от fallible_action, остальные результаты отбрасываются
+            using status_t = decltype(m_machine.functors().template action<action_t>(event, fsm, t_source, std::declval<target_t&>()));
+            static_assert(!IsFallibleAction<action_t> || IsActionStatus<status_t>, "fallible action must return bool or an expected-like status!");
+            // проверяем, что GUARD разрешает переход
+            if (!check_guard<guard_t>{}(event, fsm, t_source, m_machine.functors()))
+                return result::refuse;
+            // завершаем текущее состояние, кроме унаследованного копией
+            if (!m_machine.inherited())
                 call_on_exit{}(t_source, std::forward<E>(event), fsm);
+            if constexpr (!IsFallibleAction<action_t>) {
                 // выход из текущего состояния и переход в пустое состояние
-                m_current = typename transitions_t::empty_state{};
+                m_machine.m_current = typename transitions_t::empty_state{};
                 // создаём экземпляр следующего состояния
                 target_t t_target{};
                 // выполняем действие
-                call_action<action_t>{}(std::forward<E>(event), fsm, t_source, t_target);
+                static_cast<void>(m_machine.functors().template action<action_t>(event, fsm, t_source, t_target));
                 // выполняем переход FSM из пустого состояния в новое состояние
-                m_current = std::move(t_target);
-                // выполняем вход в новое состояние
-                call_on_entry{}(*std::get_if<target_t>(&m_current), std::forward<E>(event), fsm);
-                // помечаем результат как выполненный
-                t_result = result::done;
+                m_machine.m_current = std::move(t_target);
             }
             else {
-                using internal_transitions_t = typename std::decay_t<decltype(t_source)>::internal_transitions;
-                if constexpr (!std::is_same_v<internal_transitions_t, void>) {
-                    using event_t = std::decay_t<decltype(event)>;
-                    constexpr auto in_index = internal_transitions_t::template internal_index_of<event_t>();
-                    if constexpr (in_index < internal_transitions_t::count) {
-                        using transition_t = typename internal_transitions_t::template get_transition_type<in_index>::type;
-                        using action_t = typename transition_t::action_t;
-                        using guard_t  = typename transition_t::guard_t;
-                        // проверяем, что GUARD разрешает переход
-                        if (call_guard<guard_t>{}(std::forward<E>(event), fsm, t_source)) {
-                            // выполняем действие
-                            call_action<action_t>{}(std::forward<E>(event), fsm, t_source, t_source);
-                            t_result = result::done;
+                // сохраняем исходное состояние для отката перехода
+                source_t t_saved {std::move(t_source)};
+                m_machine.m_current = typename transitions_t::empty_state{};
+                target_t t_target{};
+                // действие завершилось неудачей - возвращаемся в исходное состояние без повторного on_entry
+                if (!action_succeeded(m_machine.functors().template action<action_t>(event, fsm, t_saved, t_target))) {
+                    m_machine.m_current = std::move(t_saved);
+                    return result::failed;
+                }
+                m_machine.m_current = std::move(t_target);
+            }
+            // новое состояние больше не унаследовано копией
+            m_machine.inherit(false);
+            // выполняем вход в новое состояние
+            call_on_entry{}(*std::get_if<target_t>(&m_machine.m_current), std::forward<E>(event), fsm);
+            // помечаем результат как выполненный
+            return result::done;
+        }
+        else {
+            using internal_transitions_t = typename S::internal_transitions;
+            if constexpr (!std::is_same_v<internal_transitions_t, void>) {
+                constexpr auto in_index = internal_transitions_t::template internal_index_of<event_t>();
+                if constexpr (in_index < internal_transitions_t::count) {
+                    using transition_t = typename internal_transitions_t::template get_transition_type<in_index>::type;
+                    using action_t = typename transition_t::action_t;
+                    using guard_t  = typename transition_t::guard_t;
+                    using status_t = decltype(m_machine.functors().template action<action_t>(event, fsm, t_source, t_source));
+                    static_assert(!IsFallibleAction<action_t> || IsActionStatus<status_t>, "fallible action must return bool or an expected-like status!");
+                    // проверяем, что GUARD разрешает переход
+                    if (check_guard<guard_t>{}(event, fsm, t_source, m_machine.functors())) {
+                        // выполняем действие
+                        if constexpr (!IsFallibleAction<action_t>) {
+                            static_cast<void>(m_machine.functors().template action<action_t>(event, fsm, t_source, t_source));
+                            return result::done;
+                        }
+                        else {
+                            return action_succeeded(m_machine.functors().template action<action_t>(event, fsm, t_source, t_source)) ? result::done : result::failed;
                         }
                     }
                 }
             }
-        }, m_current);
-        return t_result;
+        }
+        return result::refuse;
     }
 
-    /**
-     * \brief Возвращает true если FSM находится в заданном состоянии, иначе вернёт false.
-     * \tparam State - тип состояния.
-     */
-    template <IsState State>
-    [[nodiscard]] constexpr bool is_in_state() const noexcept {
-        static_assert(meta::contains<State>(typename transitions_t::all_states_t{}), "the state is missing from the transitions table");
-        return std::holds_alternative<State>(m_current);
-    }
-
-private:
-    // создаём std::variant со всеми состояниями и инициализируем начальным состоянием
-    typename transitions_t::states_t m_current {initial_state_t{}};
+    // счётчики политики профилирования
+    [[no_unique_address]] profile_storage<Policy, std::variant_size_v<states_t>, events_count> m_profile;
+    // std::variant со всеми состояниями, инициализированный начальным состоянием, и экземпляры действий и guard
+    machine_data<states_t, functor_storage_t<T>, fork_mark<has_on_exit>> m_machine {initial_state_t{}, static_cast<T&>(*this)};
 };
 
 }
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "fsm_ecpp.h"
+
+namespace ecpp::fsm {
+
+/**
+ * \struct transition_stats
+ * \brief Статистика перехода, собранная во время работы, для тепловой карты графа.
+ */
+struct transition_stats {
+    std::uint64_t hits {0};
+    double latency_ns {0};
+};
+
+/**
+ * \struct graph_row
+ * \brief Описание одного перехода графа. Для пустого действия или guard имя пустое.
+ */
+struct graph_row {
+    std::string_view source;
+    std::string_view event;
+    std::string_view target;
+    std::string_view action;
+    std::string_view guard;
+    bool internal {false};
+};
+
+namespace graph {
+
+template <class T>
+constexpr std::string_view name_of() noexcept {
+    if constexpr (std::is_same_v<T, none> || std::is_void_v<T>)
+        return {};
+    else
+        return meta::type_name<T>();
+}
+
+// имя без квалификации пространств имён и внешних классов
+constexpr std::string_view short_name(std::string_view name) noexcept {
+    std::size_t t_depth {0};
+    std::size_t t_begin {0};
+    for (std::size_t i {0}; i < name.size(); ++i) {
+        if (name[i] == '<')
+            ++t_depth;
+        else if (name[i] == '>')
+            --t_depth;
+        else if (t_depth == 0 && name[i] == ':' && i + 1 < name.size() && name[i + 1] == ':')
+            t_begin = i + 2;
+    }
+    return name.substr(t_begin);
+}
+
+constexpr void append_escaped(std::string &out, std::string_view text) {
+    for (const char c : text) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+}
+
+constexpr void append_uint(std::string &out, std::uint64_t value) {
+    char t_buffer[20] {};
+    std::size_t t_size {0};
+    do {
+        t_buffer[t_size++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (t_size > 0)
+        out += t_buffer[--t_size];
+}
+
+// число с фиксированной точкой и тремя знаками после запятой
+constexpr void append_fixed(std::string &out, double value) {
+    if (value < 0) {
+        out += '-';
+        value = -value;
+    }
+    const auto t_scaled = static_cast<std::uint64_t>(value * 1000 + 0.5);
+    append_uint(out, t_scaled / 1000);
+    out += '.';
+    const auto t_fraction = t_scaled % 1000;
+    out += static_cast<char>('0' + t_fraction / 100);
+    out += static_cast<char>('0' + t_fraction / 10 % 10);
+    out += static_cast<char>('0' + t_fraction % 10);
+}
+
+template <class V, class Empty>
+struct states_of;
+
+template <class... S, class Empty>
+struct states_of<std::variant<S...>, Empty>
+        : meta::concat<meta::type_pack<>, std::conditional_t<std::is_same_v<S, Empty>, meta::type_pack<>, meta::type_pack<S>>...> {};
+
+template <class S>
+constexpr std::size_t internal_count() noexcept {
+    if constexpr (std::is_void_v<typename S::internal_transitions>)
+        return 0;
+    else
+        return S::internal_transitions::count;
+}
+
+template <class Row, class Source, class Target>
+constexpr graph_row make_row(bool internal) noexcept {
+    return {name_of<Source>(), name_of<typename Row::event_t>(), name_of<Target>(),
+            name_of<typename Row::action_t>(), name_of<typename Row::guard_t>(), internal};
+}
+
+/**
+ * \class table
+ * \brief Описание графа таблицы переходов: список состояний и переходов.
+ * Сначала следуют переходы таблицы в порядке объявления, затем внутренние переходы состояний.
+ */
+template <class Table>
+struct table {
+    using states_t = typename states_of<typename Table::states_t, typename Table::empty_state>::type;
+
+    static constexpr std::size_t state_count = meta::pack_size<states_t>::value;
+    static constexpr std::size_t count = Table::count + []<class... S>(meta::type_pack<S...>) {
+        return (std::size_t{0} + ... + internal_count<S>());
+    }(states_t{});
+
+    static constexpr std::array<std::string_view, state_count> states() noexcept {
+        return []<class... S>(meta::type_pack<S...>) {
+            return std::array<std::string_view, state_count>{name_of<S>()...};
+        }(states_t{});
+    }
+
+    static constexpr std::array<graph_row, count> rows() noexcept {
+        std::array<graph_row, count> t_rows {};
+        std::size_t t_index {0};
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((t_rows[t_index++] = external_row<typename Table::template get_transition_type<I>::type>()), ...);
+        }(std::make_index_sequence<Table::count>{});
+        [&]<class... S>(meta::type_pack<S...>) {
+            (append_internal<S>(t_rows, t_index), ...);
+        }(states_t{});
+        return t_rows;
+    }
+
+private:
+    template <class Row>
+    static constexpr graph_row external_row() noexcept {
+        return make_row<Row, typename Row::source_t, typename Row::target_t>(false);
+    }
+
+    template <class S>
+    static constexpr void append_internal(std::array<graph_row, count> &rows, std::size_t &index) noexcept {
+        if constexpr (internal_count<S>() > 0) {
+            using internal_t = typename S::internal_transitions;
+            [&]<std::size_t... I>(std::index_sequence<I...>) {
+                ((rows[index++] = make_row<typename internal_t::template get_transition_type<I>::type, S, S>(true)), ...);
+            }(std::make_index_sequence<internal_t::count>{});
+        }
+    }
+};
+
+// таблица переходов и начальное состояние извлекаются из определения автомата, либо передаётся сама таблица
+template <class T>
+struct source_of {
+    using table_t = T;
+    using initial_t = void;
+};
+
+template <class T> requires requires { typename T::transitions; typename T::initial_state; }
+struct source_of<T> {
+    using table_t = typename T::transitions;
+    using initial_t = typename T::initial_state;
+};
+
+constexpr std::uint64_t max_hits(std::span<const transition_stats> stats) noexcept {
+    std::uint64_t t_max {0};
+    for (const auto &t_stats : stats)
+        t_max = t_stats.hits > t_max ? t_stats.hits : t_max;
+    return t_max;
+}
+
+}
+
+/**
+ * \brief Количество переходов в графе, т.е. ожидаемый размер массива статистики.
+ * \tparam T - таблица переходов или определение автомата.
+ */
+template <class T>
+constexpr std::size_t graph_size() noexcept {
+    return graph::table<typename graph::source_of<T>::table_t>::count;
+}
+
+/**
+ * \brief Экспорт графа в формате DOT (Graphviz).
+ * \tparam T - таблица переходов или определение автомата (тогда отмечается начальное состояние).
+ * \param stats - необязательная статистика переходов в порядке graph_size(); задаёт цвет и толщину рёбер.
+ */
+template <class T>
+constexpr std::string to_dot(std::span<const transition_stats> stats = {}) {
+    using table_t = graph::table<typename graph::source_of<T>::table_t>;
+    using initial_t = typename graph::source_of<T>::initial_t;
+
+    const auto t_rows = table_t::rows();
+    const auto t_max = graph::max_hits(stats);
+
+    std::string t_out {"digraph fsm {\n    rankdir=LR;\n    node [shape=box, style=rounded];\n"};
+    if constexpr (!std::is_void_v<initial_t>) {
+        t_out += "    __initial [shape=point];\n    __initial -> \"";
+        graph::append_escaped(t_out, graph::name_of<initial_t>());
+        t_out += "\";\n";
+    }
+    for (const auto t_state : table_t::states()) {
+        t_out += "    \"";
+        graph::append_escaped(t_out, t_state);
+        t_out += "\" [label=\"";
+        graph::append_escaped(t_out, graph::short_name(t_state));
+        t_out += "\"];\n";
+    }
+    for (std::size_t i {0}; i < t_rows.size(); ++i) {
+        const auto &t_row = t_rows[i];
+        t_out += "    \"";
+        graph::append_escaped(t_out, t_row.source);
+        t_out += "\" -> \"";
+        graph::append_escaped(t_out, t_row.target);
+        t_out += "\" [label=\"";
+        graph::append_escaped(t_out, graph::short_name(t_row.event));
+        if (!t_row.guard.empty()) {
+            t_out += " [";
+            graph::append_escaped(t_out, graph::short_name(t_row.guard));
+            t_out += "]";
+        }
+        if (!t_row.action.empty()) {
+            t_out += " / ";
+            graph::append_escaped(t_out, graph::short_name(t_row.action));
+        }
+        if (i < stats.size()) {
+            t_out += "\\nhits: ";
+            graph::append_uint(t_out, stats[i].hits);
+            t_out += ", ns: ";
+            graph::append_fixed(t_out, stats[i].latency_ns);
+            // тепловая карта: от синего (холодный переход) к красному (горячий)
+            const double t_heat = t_max > 0 ? static_cast<double>(stats[i].hits) / static_cast<double>(t_max) : 0.0;
+            t_out += "\", color=\"";
+            graph::append_fixed(t_out, 0.667 * (1.0 - t_heat));
+            t_out += " 1.000 0.900\", penwidth=";
+            graph::append_fixed(t_out, 1.0 + 4.0 * t_heat);
+        }
+        else {
+            t_out += "\"";
+        }
+        if (t_row.internal)
+            t_out += ", style=dashed";
+        t_out += "];\n";
+    }
+    t_out += "}\n";
+    return t_out;
+}
+
+/**
+ * \brief Экспорт графа в формате JSON.
+ * \tparam T - таблица переходов или определение автомата.
+ * \param stats - необязательная статистика переходов в порядке graph_size().
+ */
+template <class T>
+constexpr std::string to_json(std::span<const transition_stats> stats = {}) {
+    using table_t = graph::table<typename graph::source_of<T>::table_t>;
+    using initial_t = typename graph::source_of<T>::initial_t;
+
+    const auto t_rows = table_t::rows();
+    const auto t_field = [](std::string &out, std::string_view key, std::string_view value) {
+        out += "\"";
+        out += key;
+        out += "\": ";
+        if (value.empty()) {
+            out += "null";
+        }
+        else {
+            out += "\"";
+            graph::append_escaped(out, value);
+            out += "\"";
+        }
+    };
+
+    std::string t_out {"{\n  \"initial\": "};
+    if constexpr (!std::is_void_v<initial_t>) {
+        t_out += "\"";
+        graph::append_escaped(t_out, graph::name_of<initial_t>());
+        t_out += "\"";
+    }
+    else {
+        t_out += "null";
+    }
+    t_out += ",\n  \"states\": [";
+    const auto t_states = table_t::states();
+    for (std::size_t i {0}; i < t_states.size(); ++i) {
+        t_out += i == 0 ? "\n    \"" : ",\n    \"";
+        graph::append_escaped(t_out, t_states[i]);
+        t_out += "\"";
+    }
+    t_out += "\n  ],\n  \"transitions\": [";
+    for (std::size_t i {0}; i < t_rows.size(); ++i) {
+        const auto &t_row = t_rows[i];
+        t_out += i == 0 ? "\n    {" : ",\n    {";
+        t_field(t_out, "source", t_row.source);
+        t_out += ", ";
+        t_field(t_out, "event", t_row.event);
+        t_out += ", ";
+        t_field(t_out, "target", t_row.target);
+        t_out += ", ";
+        t_field(t_out, "action", t_row.action);
+        t_out += ", ";
+        t_field(t_out, "guard", t_row.guard);
+        t_out += t_row.internal ? ", \"internal\": true" : ", \"internal\": false";
+        if (i < stats.size()) {
+            t_out += ", \"hits\": ";
+            graph::append_uint(t_out, stats[i].hits);
+            t_out += ", \"latency_ns\": ";
+            graph::append_fixed(t_out, stats[i].latency_ns);
+        }
+        t_out += "}";
+    }
+    t_out += "\n  ]\n}\n";
+    return t_out;
+}
+
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "fsm_ecpp.h"
+
+namespace ecpp::fsm {
+
+template <class... Defs>
+class pipeline;
+
+struct emitter_base {};
+
+template<class T>
+concept IsEmitter = std::is_base_of_v<emitter_base, T>;
+
+/**
+ * \class emits
+ * \brief Базовый класс определения автомата, действия которого порождают события для следующего автомата конвейера.
+ * События складываются в ограниченный буфер внутри автомата и передаются дальше
+ * после завершения обработки текущего события, без выделения памяти и стирания типов.
+ * Если событие не привело к переходу (например, действие сообщило о неудаче), порождённые события отбрасываются.
+ * Вне конвейера буфер очищается автоматом перед обработкой каждого события, поэтому emit() не переполняет его навсегда.
+ * \tparam Downstream - определение автомата, которому предназначены события.
+ * \tparam Capacity - максимальное количество событий, порождаемых при обработке одного входного события.
+ * \tparam Events - типы порождаемых событий.
+ */
+template <class Downstream, std::size_t Capacity, class... Events>
+class emits : public emitter_base {
+    static_assert(Capacity > 0, "emits capacity must be greater than zero");
+    static_assert(sizeof...(Events) > 0, "emits must declare at least one event type");
+
+public:
+    using downstream_t = Downstream;
+    using emitted_events_t = meta::type_pack<Events...>;
+
+    /**
+     * \brief Передача события следующему автомату.
+     * \return false, если буфер заполнен и событие отброшено.
+     */
+    template <class E> requires (meta::contains<std::decay_t<E>>(meta::type_pack<Events...>{}))
+    bool emit(E &&event) noexcept {
+        if (m_size == Capacity)
+            return false;
+        m_outbox[m_size++].template emplace<std::decay_t<E>>(std::forward<E>(event));
+        return true;
+    }
+
+private:
+    template <class... Defs>
+    friend class pipeline;
+
+    // очистка буфера без передачи событий, вызывается автоматом через ADL перед обработкой события
+    friend constexpr void discard_outbox(emits &emitter) noexcept {
+        for (std::size_t i {0}; i < emitter.m_size; ++i)
+            emitter.m_outbox[i].template emplace<std::monostate>();
+        emitter.m_size = 0;
+    }
+
+    std::array<std::variant<std::monostate, Events...>, Capacity> m_outbox {};
+    std::size_t m_size {0};
+};
+
+/**
+ * \class pipeline
+ * \brief Конвейер автоматов: события, порождённые действиями автомата, сразу обрабатываются следующим автоматом.
+ * \tparam Defs - определения автоматов в порядке следования; каждое, кроме последнего, наследует emits<следующее, ...>.
+ */
+template <class... Defs>
+class pipeline {
+    static constexpr std::size_t count = sizeof...(Defs);
+    static_assert(count > 0, "pipeline must contain at least one machine");
+
+    using defs_t = meta::type_pack<Defs...>;
+
+    template <std::size_t I>
+    static constexpr bool check_stage() noexcept {
+        using def_t = meta::pack_element_t<I, defs_t>;
+        if constexpr (I + 1 < count) {
+            using next_t = meta::pack_element_t<I + 1, defs_t>;
+            static_assert(IsEmitter<def_t>, "pipeline stage must derive from emits<next stage, ...>");
+            static_assert(std::is_same_v<typename def_t::downstream_t, next_t>, "pipeline stage emits events to another machine");
+            static_assert([]<class... E>(meta::type_pack<E...>) {
+                return (state_machine<next_t>::transitions_t::template has_event<E>::value && ...);
+            }(typename def_t::emitted_events_t{}), "emitted event is missing from the transition table of the next stage");
+        }
+        else {
+            static_assert(!IsEmitter<def_t>, "the last pipeline stage has no machine to emit events to");
+        }
+        return true;
+    }
+
+    static_assert([]<std::size_t... I>(std::index_sequence<I...>) {
+        return (check_stage<I>() && ...);
+    }(std::make_index_sequence<count>{}));
+
+public:
+    pipeline() noexcept = default;
+    pipeline(const pipeline&) = delete;
+    pipeline& operator=(const pipeline&) = delete;
+
+    /**
+     * \brief Обработка события первым автоматом конвейера с последующей передачей порождённых событий.
+     * \return результат обработки события первым автоматом; результаты следующих автоматов учитываются в undelivered().
+     */
+    template <class E>
+    result process_event(E &&event) noexcept {
+        return dispatch<0>(std::forward<E>(event));
+    }
+
+    /**
+     * \brief Количество порождённых событий, которые следующий автомат отклонил или не смог обработать.
+     */
+    [[nodiscard]] std::size_t undelivered() const noexcept { return m_undelivered; }
+
+    template <std::size_t I>
+    [[nodiscard]] auto &stage() noexcept { return std::get<I>(m_stages); }
+
+    template <std::size_t I>
+    [[nodiscard]] const auto &stage() const noexcept { return std::get<I>(m_stages); }
+
+private:
+    template <std::size_t I, class E>
+    result dispatch(E &&event) noexcept {
+        auto &t_stage = std::get<I>(m_stages);
+        const auto t_result = t_stage.process_event(std::forward<E>(event));
+        if constexpr (I + 1 < count) {
+            auto &t_emitter = static_cast<meta::pack_element_t<I, defs_t>&>(t_stage);
+            // следующий автомат не может породить события для текущего, поэтому буфер стабилен во время обхода;
+            // если переход не выполнен, события, порождённые до отказа, отбрасываются
+            if (t_result == result::done) {
+                for (std::size_t i {0}; i < t_emitter.m_size; ++i) {
+                    std::visit([this](auto &t_event) noexcept {
+                        if constexpr (!std::is_same_v<std::decay_t<decltype(t_event)>, std::monostate>) {
+                            if (dispatch<I + 1>(std::move(t_event)) != result::done)
+                                ++m_undelivered;
+                        }
+                    }, t_emitter.m_outbox[i]);
+                }
+            }
+            discard_outbox(t_emitter);
+        }
+        return t_result;
+    }
+
+    std::tuple<state_machine<Defs>...> m_stages;
+    std::size_t m_undelivered {0};
+};
+
+}
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ECPP_FSM_SCANNER_SSE2 1
+#endif
+
+#include "fsm_ecpp.h"
+
+namespace ecpp::fsm {
+
+/**
+ * \struct byte_classes
+ * \brief Базовый класс описания классов входных байтов.
+ * Наследник должен определить static constexpr std::size_t classify(std::byte) noexcept,
+ * возвращающую номер события в списке Events (или sizeof...(Events), если байт не соответствует ни одному событию).
+ * \tparam Events - события таблицы переходов, соответствующие классам байтов.
+ */
+template <class... Events>
+struct byte_classes {
+    using events_t = meta::type_pack<Events...>;
+};
+
+template <class C>
+concept IsByteClasses = requires(std::byte b) {
+    typename C::events_t;
+    { C::classify(b) } -> std::convertible_to<std::size_t>;
+};
+
+/**
+ * \class scanner
+ * \brief Табличный сканер байтового потока на основе таблицы переходов автомата.
+ * Таблица переходов компилируется в плотный массив следующих состояний на 256 столбцов.
+ * Переходы без действий, guard и обработчиков on_entry/on_exit выполняются прямо по массиву,
+ * остальные передаются в state_machine::process_event.
+ * \tparam Def - определение автомата.
+ * \tparam Classes - классы байтов (наследник byte_classes).
+ * \tparam SimdSkip - разрешает векторный пропуск серий байтов, не выводящих автомат из текущего состояния.
+ */
+template <class Def, class Classes, bool SimdSkip = true>
+class scanner {
+    static_assert(IsByteClasses<Classes>, "Classes must derive from byte_classes and define classify(std::byte)");
+
+public:
+    using machine_t = state_machine<Def>;
+
+    struct scan_result {
+        // количество обработанных байтов
+        std::size_t consumed {0};
+        // result::done - обработан весь буфер, иначе результат события на байте input[consumed]
+        result status {result::done};
+    };
+
+    template <typename... Args>
+    explicit scanner(Args&&... args) noexcept : m_fsm{std::forward<Args>(args)...} {}
+
+    [[nodiscard]] machine_t &machine() noexcept { return m_fsm; }
+    [[nodiscard]] const machine_t &machine() const noexcept { return m_fsm; }
+
+    /**
+     * \brief Обработка буфера. Останавливается на первом байте, событие которого не выполнено.
+     */
+    scan_result scan(std::span<const std::byte> input) noexcept {
+        const auto *t_begin = input.data();
+        const auto *t_end = t_begin + input.size();
+        const auto *t_pos = t_begin;
+        std::size_t t_state = m_fsm.m_machine.m_current.index();
+        bool t_dirty = false;
+
+        while (t_pos != t_end) {
+            if constexpr (SimdSkip) {
+                if (skips[t_state].count != 0) {
+                    t_pos = skip(skips[t_state], t_pos, t_end);
+                    if (t_pos == t_end)
+                        break;
+                }
+            }
+            const auto t_byte = static_cast<std::uint8_t>(*t_pos);
+            const auto t_cell = cells[t_state * 256 + t_byte];
+            if (t_cell & cell_slow) [[unlikely]] {
+                sync(t_state, t_dirty);
+                const auto t_result = dispatch(classes[t_byte], *t_pos, std::make_index_sequence<class_count>{});
+                if (t_result != result::done)
+                    return {static_cast<std::size_t>(t_pos - t_begin), t_result};
+                t_state = m_fsm.m_machine.m_current.index();
+            }
+            else if (t_cell & cell_refuse) [[unlikely]] {
+                sync(t_state, t_dirty);
+                return {static_cast<std::size_t>(t_pos - t_begin), result::refuse};
+            }
+            else {
+                t_dirty |= t_cell != t_state;
+                t_state = t_cell;
+            }
+            ++t_pos;
+        }
+        sync(t_state, t_dirty);
+        return {input.size(), result::done};
+    }
+
+private:
+    using transitions_t = typename machine_t::transitions_t;
+    using states_t = typename machine_t::states_t;
+    using classes_t = typename Classes::events_t;
+
+    static constexpr std::size_t state_count = std::variant_size_v<states_t>;
+    static constexpr std::size_t class_count = meta::pack_size<classes_t>::value;
+
+    static_assert(state_count < 0x4000, "too many states for the scanner table");
+    static_assert([]<class... E>(meta::type_pack<E...>) { return (transitions_t::template has_event<E>::value && ...); }(classes_t{}),
+                  "byte class event is missing from the transition table!");
+
+    // ячейка: номер следующего состояния либо признаки
+    static constexpr std::uint16_t cell_slow   = 0x8000;
+    static constexpr std::uint16_t cell_refuse = 0x4000;
+
+    template <class E>
+    static E make_event(std::byte value) noexcept {
+        if constexpr (std::is_constructible_v<E, std::byte>)
+            return E{value};
+        else
+            return E{};
+    }
+
+    template <class S, class E>
+    static constexpr std::uint16_t make_cell(std::size_t state) noexcept {
+        if constexpr (std::is_same_v<S, typename transitions_t::empty_state>) {
+            return cell_refuse;
+        }
+        else {
+            constexpr auto tr_index = transitions_t::template index_of<meta::type_pack<S, E>>();
+            if constexpr (tr_index < transitions_t::count) {
+                using transition_t = typename transitions_t::template get_transition_type<tr_index>::type;
+                using target_t = typename transition_t::target_t;
+                constexpr bool is_plain = std::is_same_v<typename transition_t::action_t, none>
+                                       && std::is_same_v<typename transition_t::guard_t, none>
+                                       && !CallOnExit<S, E, Def> && !CallOnEntry<target_t, E, Def>;
+                if constexpr (is_plain)
+                    return static_cast<std::uint16_t>(meta::pack_index<target_t, typename meta::variant_pack<states_t>::type>::value);
+                else
+                    return cell_slow;
+            }
+            else if constexpr (!std::is_void_v<typename S::internal_transitions>) {
+                using internal_t = typename S::internal_transitions;
+                constexpr auto in_index = internal_t::template internal_index_of<E>();
+                if constexpr (in_index < internal_t::count) {
+                    using transition_t = typename internal_t::template get_transition_type<in_index>::type;
+                    if constexpr (std::is_same_v<typename transition_t::action_t, none> && std::is_same_v<typename transition_t::guard_t, none>)
+                        return static_cast<std::uint16_t>(state);
+                    else
+                        return cell_slow;
+                }
+                else {
+                    return cell_refuse;
+                }
+            }
+            else {
+                return cell_refuse;
+            }
+        }
+    }
+
+    // класс каждого байта
+    static constexpr std::array<std::uint8_t, 256> classes = [] {
+        static_assert(class_count < 0xFF, "too many byte classes");
+        std::array<std::uint8_t, 256> t_classes {};
+        for (std::size_t i {0}; i < 256; ++i) {
+            const std::size_t t_class = Classes::classify(static_cast<std::byte>(i));
+            t_classes[i] = static_cast<std::uint8_t>(t_class < class_count ? t_class : class_count);
+        }
+        return t_classes;
+    }();
+
+    using class_cells_t = std::array<std::uint16_t, state_count * (class_count + 1)>;
+
+    // строка таблицы состояние x класс байта, последний столбец - байты без класса
+    template <std::size_t S, std::size_t... C>
+    static constexpr void fill_state(class_cells_t &cells, std::index_sequence<C...>) noexcept {
+        ((cells[S * (class_count + 1) + C] = make_cell<std::variant_alternative_t<S, states_t>, meta::pack_element_t<C, classes_t>>(S)), ...);
+        cells[S * (class_count + 1) + class_count] = cell_refuse;
+    }
+
+    template <std::size_t... S>
+    static constexpr class_cells_t make_class_cells(std::index_sequence<S...>) noexcept {
+        class_cells_t t_cells {};
+        (fill_state<S>(t_cells, std::make_index_sequence<class_count>{}), ...);
+        return t_cells;
+    }
+
+    // плотная таблица: состояние x 256 байтов
+    static constexpr std::array<std::uint16_t, state_count * 256> cells = [] {
+        const auto t_by_class = make_class_cells(std::make_index_sequence<state_count>{});
+
+        std::array<std::uint16_t, state_count * 256> t_cells {};
+        for (std::size_t s {0}; s < state_count; ++s) {
+            for (std::size_t b {0}; b < 256; ++b)
+                t_cells[s * 256 + b] = t_by_class[s * (class_count + 1) + classes[b]];
+        }
+        return t_cells;
+    }();
+
+    // байты, на которых прекращается пропуск (все байты, кроме оставляющих автомат в текущем состоянии)
+    struct skip_set {
+        std::uint8_t count {0};
+        std::uint8_t bytes[4] {};
+    };
+
+    static constexpr std::array<skip_set, state_count> skips = [] {
+        std::array<skip_set, state_count> t_skips {};
+        for (std::size_t s {0}; s < state_count; ++s) {
+            std::size_t t_count {0};
+            for (std::size_t b {0}; b < 256; ++b) {
+                if (cells[s * 256 + b] == s)
+                    continue;
+                if (t_count < 4)
+                    t_skips[s].bytes[t_count] = static_cast<std::uint8_t>(b);
+                ++t_count;
+            }
+            // пропуск выгоден только при небольшом наборе байтов-ограничителей
+            t_skips[s].count = t_count <= 4 ? static_cast<std::uint8_t>(t_count) : 0;
+        }
+        return t_skips;
+    }();
+
+    // возвращает указатель на первый байт-ограничитель либо на конец буфера
+    static const std::byte *skip(const skip_set &set, const std::byte *pos, const std::byte *end) noexcept {
+#if defined(ECPP_FSM_SCANNER_SSE2)
+        __m128i t_stops[4];
+        for (std::size_t i {0}; i < 4; ++i)
+            t_stops[i] = _mm_set1_epi8(static_cast<char>(set.bytes[i < set.count ? i : 0]));
+        while (end - pos >= 16) {
+            const auto t_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+            const auto t_match = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(t_block, t_stops[0]), _mm_cmpeq_epi8(t_block, t_stops[1])),
+                                              _mm_or_si128(_mm_cmpeq_epi8(t_block, t_stops[2]), _mm_cmpeq_epi8(t_block, t_stops[3])));
+            const auto t_mask = static_cast<unsigned>(_mm_movemask_epi8(t_match));
+            if (t_mask != 0)
+                return pos + std::countr_zero(t_mask);
+            pos += 16;
+        }
+#endif
+        for (; pos != end; ++pos) {
+            const auto t_byte = static_cast<std::uint8_t>(*pos);
+            for (std::size_t i {0}; i < set.count; ++i) {
+                if (t_byte == set.bytes[i])
+                    return pos;
+            }
+        }
+        return end;
+    }
+
+    // приведение состояния автомата к состоянию сканера
+    void sync(std::size_t state, bool &dirty) noexcept {
+        if (!dirty)
+            return;
+        emplace(state, std::make_index_sequence<state_count>{});
+        dirty = false;
+    }
+
+    template <std::size_t... I>
+    void emplace(std::size_t state, std::index_sequence<I...>) noexcept {
+        ((state == I ? (m_fsm.m_machine.m_current.template emplace<I>(), void()) : void()), ...);
+    }
+
+    template <std::size_t... C>
+    result dispatch(std::size_t event_class, std::byte value, std::index_sequence<C...>) noexcept {
+        auto t_result {result::refuse};
+        ((event_class == C ? (t_result = m_fsm.process_event(make_event<meta::pack_element_t<C, classes_t>>(value)), void()) : void()), ...);
+        return t_result;
+    }
+
+    machine_t m_fsm;
+};
+
+}